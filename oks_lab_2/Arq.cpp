@@ -0,0 +1,137 @@
+﻿#include "Arq.h"
+#include <algorithm>
+
+namespace ARQ {
+
+    int max_window(Mode mode) {
+        return mode == Mode::SelectiveRepeat ? MAX_WINDOW_SR : MAX_WINDOW_GBN;
+    }
+
+    void encode_ack_payload(const Ack& ack, uint8_t (&out)[ACK_PAYLOAD_SIZE]) {
+        out[0] = ACK_FRAME_TAG;
+        for (int i = 0; i < 8; ++i) {
+            out[1 + i] = static_cast<uint8_t>(ack.selective >> (i * 8));
+        }
+    }
+
+    bool decode_ack_frame(const Frame& frame, Ack& ack) {
+        if (frame.data.size() != ACK_PAYLOAD_SIZE || frame.data[0] != ACK_FRAME_TAG) return false;
+
+        ack.cumulative = frame.seqNumber;
+        ack.selective = 0;
+        for (int i = 0; i < 8; ++i) {
+            ack.selective |= static_cast<uint64_t>(frame.data[1 + i]) << (i * 8);
+        }
+        return true;
+    }
+
+    // --- Передатчик ---
+
+    void Sender::reset(Mode newMode, int newWindow, uint8_t firstSeq, Clock::duration newTimeout) {
+        mode = newMode;
+        window = std::clamp(newWindow, 1, max_window(newMode));
+        base = firstSeq;
+        next = firstSeq;
+        timeout = newTimeout;
+    }
+
+    uint64_t Sender::openSession(uint64_t nowMs) {
+        session = std::max(nowMs, session + 1);
+        return session;
+    }
+
+    void Sender::onSent(Clock::time_point now) {
+        Slot& slot = slots[next];
+        slot.deadline = now + timeout;
+        slot.retransmissions = 0;
+        slot.acked = false;
+        next++;
+    }
+
+    void Sender::onRetransmitted(uint8_t seq, Clock::time_point now) {
+        Slot& slot = slots[seq];
+        slot.deadline = now + timeout;
+        // В Go-Back-N истекает только таймер base, остальные кадры окна
+        // уходят вместе с ним и попыткой не считаются
+        if (mode != Mode::GoBackN || seq == base) slot.retransmissions++;
+    }
+
+    void Sender::onGoBackSent(Clock::time_point now) {
+        // Повтор окна длиннее тайм-аута одного кадра: без перезапуска таймер
+        // base истек бы еще до конца повтора и запустил следующий
+        if (mode != Mode::GoBackN) return;
+        for (uint8_t seq = base; seq != next; ++seq) slots[seq].deadline = now + timeout;
+    }
+
+    void Sender::onAck(const Ack& ack) {
+        // Подтверждение вне [base, next] устарело или относится к другой сессии
+        uint8_t advanced = seq_distance(base, ack.cumulative);
+        if (advanced > outstanding()) return;
+
+        base = ack.cumulative;
+        // Выборочное подтверждение base не окончательно: приемник держит кадр
+        // в буфере, но мог не отдать его в полную очередь. Пока cumulative
+        // его не прошел, base повторяется по тайм-ауту
+        slots[base].acked = false;
+
+        if (mode == Mode::SelectiveRepeat) {
+            for (int i = 0; i < 64; ++i) {
+                if (!((ack.selective >> i) & 1)) continue;
+                uint8_t seq = static_cast<uint8_t>(ack.cumulative + 1 + i);
+                if (seq_distance(base, seq) < outstanding()) {
+                    slots[seq].acked = true;
+                }
+            }
+        }
+    }
+
+    void Sender::dueRetransmissions(Clock::time_point now, std::vector<uint8_t>& out) const {
+        out.clear();
+        if (allAcked()) return;
+
+        if (mode == Mode::GoBackN) {
+            // Истек таймер самого старого кадра — повторяем все окно
+            if (slots[base].deadline <= now) {
+                for (uint8_t seq = base; seq != next; ++seq) out.push_back(seq);
+            }
+            return;
+        }
+
+        for (uint8_t seq = base; seq != next; ++seq) {
+            const Slot& slot = slots[seq];
+            if (!slot.acked && slot.deadline <= now) out.push_back(seq);
+        }
+    }
+
+    Clock::time_point Sender::nextDeadline() const {
+        Clock::time_point earliest = Clock::time_point::max();
+        for (uint8_t seq = base; seq != next; ++seq) {
+            const Slot& slot = slots[seq];
+            if (!slot.acked) earliest = std::min(earliest, slot.deadline);
+        }
+        return earliest;
+    }
+
+    // --- Приемник ---
+
+    void Receiver::reset(Mode newMode, int newWindow, uint8_t newExpected) {
+        mode = newMode;
+        window = std::clamp(newWindow, 1, max_window(newMode));
+        expected = newExpected;
+        present.reset();
+    }
+
+    Ack Receiver::ack() const {
+        Ack result;
+        result.cumulative = expected;
+        if (mode == Mode::SelectiveRepeat) {
+            for (int i = 0; i < 64; ++i) {
+                if (present[static_cast<uint8_t>(expected + 1 + i)]) {
+                    result.selective |= static_cast<uint64_t>(1) << i;
+                }
+            }
+        }
+        return result;
+    }
+
+}
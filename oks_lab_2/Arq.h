@@ -0,0 +1,164 @@
+#pragma once
+#include <array>
+#include <bitset>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+#include "Frame.h"
+
+//      (Go-Back-N / Selective Repeat).
+//
+//    dataLen == 0  SYNC:     .
+//      ,   seqNumber 
+//    ,    ACK_FRAME_TAG  
+//      (  Selective Repeat).
+namespace ARQ {
+    enum class Mode {
+        Off,
+        GoBackN,
+        SelectiveRepeat
+    };
+
+    using Clock = std::chrono::steady_clock;
+
+    const uint8_t ACK_FRAME_TAG = 0x06;
+    const size_t ACK_PAYLOAD_SIZE = 9;
+
+    const int DEFAULT_WINDOW = 8;
+    const int MAX_WINDOW_GBN = 255;     //     (256)
+    const int MAX_WINDOW_SR = 64;       //       
+    const int RETRANSMIT_TIMEOUT_MS = 300;
+    const int MAX_RETRANSMISSIONS = 16;
+
+    int max_window(Mode mode);
+
+    //   base  seq    8- 
+    inline uint8_t seq_distance(uint8_t base, uint8_t seq) {
+        return static_cast<uint8_t>(seq - base);
+    }
+
+    struct Ack {
+        uint8_t cumulative = 0;     //     
+        uint64_t selective = 0;     //  i    cumulative + 1 + i
+    };
+
+    void encode_ack_payload(const Ack& ack, uint8_t (&out)[ACK_PAYLOAD_SIZE]);
+    bool decode_ack_frame(const Frame& frame, Ack& ack);
+
+    //   . -  .
+    class Sender {
+    public:
+        void reset(Mode mode, int window, uint8_t firstSeq, Clock::duration timeout);
+
+        bool canSend() const { return outstanding() < window; }
+        bool allAcked() const { return next == base; }
+        int outstanding() const { return seq_distance(base, next); }
+        uint8_t nextSeq() const { return next; }
+
+        //    seq 
+        bool isPending(uint8_t seq) const {
+            return seq_distance(base, seq) < outstanding() && !slots[seq].acked;
+        }
+        bool retriesLeft(uint8_t seq) const { return slots[seq].retransmissions < MAX_RETRANSMISSIONS; }
+
+        //    (  SYNC):  ,  
+        //          
+        uint64_t openSession(uint64_t nowMs);
+
+        void onSent(Clock::time_point now);
+        void onRetransmitted(uint8_t seq, Clock::time_point now);
+        // Go-Back-N:   ,  base  
+        void onGoBackSent(Clock::time_point now);
+        void onAck(const Ack& ack);
+
+        //  ,    ,   
+        void dueRetransmissions(Clock::time_point now, std::vector<uint8_t>& out) const;
+        Clock::time_point nextDeadline() const;
+
+    private:
+        struct Slot {
+            Clock::time_point deadline;
+            int retransmissions = 0;
+            bool acked = false;
+        };
+
+        Mode mode = Mode::Off;
+        int window = 1;
+        uint8_t base = 0;
+        uint8_t next = 0;
+        uint64_t session = 0;
+        Clock::duration timeout{};
+        std::array<Slot, 256> slots;
+    };
+
+    //   
+    class Receiver {
+    public:
+        void reset(Mode mode, int window, uint8_t expected);
+
+        //  SYNC.      
+        // Sender::openSession,     : 
+        //   SYNC ,     .
+        template <typename Deliver>
+        void sync(uint8_t seq, uint64_t sessionId, Mode newMode, int newWindow, Deliver&& deliver) {
+            if (sessionId == session) return;
+            session = sessionId;
+
+            if (seq != expected || newMode != mode || newWindow != window) {
+                reset(newMode, newWindow, seq);
+            }
+            advance(deliver);
+        }
+
+        //   ;    deliver   .
+        // deliver  false,    :  
+        //  ,      
+        template <typename Deliver>
+        void accept(Frame&& frame, Deliver&& deliver) {
+            if (mode == Mode::Off) return; // SYNC :    
+            flush(deliver);
+            uint8_t d = seq_distance(expected, frame.seqNumber);
+            if (d >= window) return; //    ,   
+
+            if (d == 0) {
+                //     ,     
+                if (present[expected] || !deliver(frame)) return;
+                advance(deliver);
+                return;
+            }
+            if (mode == Mode::SelectiveRepeat && !present[frame.seqNumber]) {
+                buffered[frame.seqNumber] = std::move(frame);
+                present[frame.seqNumber] = true;
+            }
+            // Go-Back-N     
+        }
+
+        //   SYNC  : cumulative   
+        //       
+        bool inSession() const { return mode != Mode::Off; }
+        Ack ack() const;
+
+    private:
+        Mode mode = Mode::Off;
+        int window = 1;
+        uint8_t expected = 0;
+        uint64_t session = 0;
+        std::array<Frame, 256> buffered;
+        std::bitset<256> present;
+
+        template <typename Deliver>
+        void advance(Deliver& deliver) {
+            expected++;
+            flush(deliver);
+        }
+
+        //     ,  deliver  
+        template <typename Deliver>
+        void flush(Deliver& deliver) {
+            while (present[expected] && deliver(buffered[expected])) {
+                present[expected] = false;
+                expected++;
+            }
+        }
+    };
+}
@@ -0,0 +1,499 @@
+﻿#include "AsyncLink.h"
+
+#ifdef __linux__
+#include <algorithm>
+#include <chrono>
+#include "HammingBlock.h"
+#include "Lz.h"
+
+using Counter = CSMA::StatsRecorder::Counter;
+using Histogram = CSMA::StatsRecorder::Histogram;
+
+namespace {
+    // Сколько раз подряд читать порт за одно событие: остальное — на следующей итерации
+    const int MAX_READS_PER_EVENT = 16;
+}
+
+AsyncLink::AsyncLink(Reactor& reactor, const CSMA::Params& params, uint32_t seed) :
+    reactor(reactor),
+    params(params),
+    rng(seed) {
+    backoff = BackoffStrategy::create(params, rng());
+    // Номер увеличивается перед каждым кадром: первый уйдет с номером 1,
+    // как у COMPortManager::sendUnreliable
+    txFrame.sender = 0;
+    txFrame.receiver = 0;
+    txFrame.timestamp = 0;
+    txFrame.seqNumber = 0;
+    txFrame.dataLen = 0;
+}
+
+AsyncLink::~AsyncLink() {
+    close();
+}
+
+bool AsyncLink::open(const std::string& sendName, const std::string& receiveName, uint32_t baud) {
+    close();
+
+    std::unique_ptr<Transport> tx = Transport::create(sendName);
+    std::unique_ptr<Transport> rx = Transport::create(receiveName);
+    if (!tx->open(sendName, baud) || !rx->open(receiveName, baud)) return false;
+    if (tx->readinessHandle() < 0 || rx->readinessHandle() < 0) return false;
+
+    sendPort = std::move(tx);
+    receivePort = std::move(rx);
+    sendPortName = sendName;
+    receivePortName = receiveName;
+    baudRate = baud;
+    traceChannel = Transport::portNumber(sendName);
+
+    line = std::make_shared<LineReceiver>(params, rng());
+    line->setReply([this](uint8_t byte) {
+        if (receivePort) receivePort->write(std::span<const uint8_t>(&byte, 1));
+    });
+    line->setFrameHandler([this](Frame& parsed) {
+        noise.apply(parsed.data, rng);
+        stats.add(Counter::FramesReceived);
+        if (rawFrameHandler) {
+            rawFrameHandler(parsed);
+            return;
+        }
+        HammingStatus status = parsed.check();
+        Trace::emit(Trace::Event::EccResult, traceChannel, static_cast<uint32_t>(status));
+        switch (status) {
+        case HammingStatus::Clean: stats.add(Counter::EccClean); break;
+        case HammingStatus::SingleCorrected: stats.add(Counter::EccCorrected); break;
+        case HammingStatus::DoubleDetected: stats.add(Counter::Uncorrectable); break;
+        }
+        deliver(parsed);
+    });
+
+    if (!reactor.watch(sendPort->readinessHandle(), [this] { onSendPortReadable(); }) ||
+        !reactor.watch(receivePort->readinessHandle(), [this] { onReceivePortReadable(); })) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void AsyncLink::close() {
+    if (sendPort) reactor.unwatch(sendPort->readinessHandle());
+    if (receivePort) reactor.unwatch(receivePort->readinessHandle());
+    cancelTimer();
+
+    // Порты и приемник освобождаются из цикла событий: close() может быть
+    // вызван из обработчика, который еще работает с ними
+    if (sendPort || receivePort) {
+        std::shared_ptr<Transport> oldSend(std::move(sendPort));
+        std::shared_ptr<Transport> oldReceive(std::move(receivePort));
+        std::shared_ptr<LineReceiver> oldLine(std::move(line));
+        reactor.post([oldSend, oldReceive, oldLine] {});
+    }
+    inbox.clear();
+    closeCount++;
+
+    // Сообщаем о прерванных операциях: обработчики могут снова обратиться
+    // к линии, поэтому очереди сначала забираются целиком
+    txState = TxState::Idle;
+    Done pendingTx = std::move(txDone);
+    txDone = nullptr;
+    std::deque<Outgoing> pendingSends;
+    pendingSends.swap(outbox);
+    std::deque<PendingReceive> pendingWaiters;
+    pendingWaiters.swap(frameWaiters);
+    for (PendingReceive& pending : pendingWaiters) {
+        if (pending.timer != 0) reactor.cancelTimer(pending.timer);
+    }
+
+    // Текущая операция send() сама завершает свое сообщение
+    if (pendingTx && pendingSends.empty()) pendingTx(false);
+    for (Outgoing& out : pendingSends) {
+        if (out.done) out.done(false);
+    }
+    for (PendingReceive& pending : pendingWaiters) {
+        pending.waiter(std::nullopt);
+    }
+}
+
+void AsyncLink::defer(Reactor::Callback callback) {
+    reactor.post([alive = std::weak_ptr<int>(lifetime), callback = std::move(callback)] {
+        if (alive.lock()) callback();
+    });
+}
+
+void AsyncLink::setTimer(Timing::Clock::time_point when, Reactor::Callback callback) {
+    cancelTimer();
+    txTimer = reactor.addTimer(when, [this, callback = std::move(callback)] {
+        txTimer = 0;
+        callback();
+    });
+}
+
+void AsyncLink::cancelTimer() {
+    if (txTimer != 0) {
+        reactor.cancelTimer(txTimer);
+        txTimer = 0;
+    }
+}
+
+void AsyncLink::finishTx(bool ok) {
+    cancelTimer();
+    txState = TxState::Idle;
+    Done done = std::move(txDone);
+    txDone = nullptr;
+    if (done) done(ok);
+}
+
+// --- ЗАХВАТ КАНАЛА ---
+
+void AsyncLink::acquire(Done done) {
+    if (!isOpen() || txState != TxState::Idle) {
+        reactor.post([done = std::move(done)] { done(false); });
+        return;
+    }
+    txDone = std::move(done);
+    startListening();
+}
+
+void AsyncLink::startListening() {
+    stats.add(Counter::TotalAttempts);
+
+    // Устаревшие ACK/COL от прошлых попыток не должны засчитаться этой
+    uint8_t stale[64];
+    while (sendPort->readUntil(stale, Timing::Clock::now()) > 0) {
+    }
+
+    uint8_t enq = CSMA::ENQ;
+    sendPort->write(std::span<const uint8_t>(&enq, 1));
+    Trace::emit(Trace::Event::EnqSent, traceChannel, static_cast<uint32_t>(frameAttempts + 1));
+    txState = TxState::Listening;
+    slotEnd = Timing::Clock::now() + std::chrono::milliseconds(params.slotTimeMs);
+    setTimer(slotEnd, [this] { onSlotExpired(); });
+}
+
+void AsyncLink::onSlotExpired() {
+    stats.add(Counter::BusyEvents);
+    Trace::emit(Trace::Event::ChannelBusy, traceChannel);
+    txState = TxState::Waiting;
+    auto retryAt = slotEnd + backoff->busyDelaySlots() * std::chrono::milliseconds(params.slotTimeMs);
+    Trace::emit(Trace::Event::BackoffBegin, traceChannel, Trace::micros(retryAt - Timing::Clock::now()));
+    setTimer(retryAt, [this] {
+        Trace::emit(Trace::Event::BackoffEnd, traceChannel);
+        startListening();
+    });
+}
+
+void AsyncLink::onAck() {
+    Trace::emit(Trace::Event::AckReceived, traceChannel);
+    if (!backoff->shouldTransmit()) {
+        // p-настойчивый доступ: свободный слот пропущен
+        txState = TxState::Waiting;
+        Trace::emit(Trace::Event::BackoffBegin, traceChannel, Trace::micros(std::chrono::milliseconds(params.slotTimeMs)));
+        setTimer(Timing::Clock::now() + std::chrono::milliseconds(params.slotTimeMs), [this] {
+            Trace::emit(Trace::Event::BackoffEnd, traceChannel);
+            startListening();
+        });
+        return;
+    }
+    finishTx(true);
+}
+
+void AsyncLink::onSendPortReadable() {
+    bool ack = false;
+    bool collision = false;
+
+    uint8_t buffer[64];
+    for (int i = 0; i < MAX_READS_PER_EVENT && sendPort; ++i) {
+        size_t got = sendPort->readUntil(buffer, Timing::Clock::now());
+        if (got == 0) break;
+        for (size_t j = 0; j < got; ++j) {
+            if (buffer[j] == CSMA::ACK) ack = true;
+            else if (buffer[j] == CSMA::COL) collision = true;
+        }
+    }
+
+    if (ack && txState == TxState::Listening) onAck();
+    else if (collision && txState == TxState::Transmitting) onCollision();
+}
+
+// --- ПЕРЕДАЧА ---
+
+void AsyncLink::transmit(std::span<const uint8_t> raw, Done done) {
+    if (!isOpen() || txState != TxState::Idle) {
+        reactor.post([done = std::move(done)] { done(false); });
+        return;
+    }
+    txDone = std::move(done);
+    txRaw = raw;
+    txSent = 0;
+    txStart = Timing::Clock::now();
+    txState = TxState::Transmitting;
+    Trace::emit(Trace::Event::TxBegin, traceChannel, static_cast<uint32_t>(raw.size()));
+    transmitNextChunk();
+}
+
+// Порции в темпе линии (8N1: 10 бит на байт), как COMPortManager::transmitFrame.
+// Срок порции отсчитывается от начала кадра
+void AsyncLink::transmitNextChunk() {
+    using namespace std::chrono;
+
+    if (txSent >= txRaw.size()) {
+        Trace::emit(Trace::Event::TxEnd, traceChannel);
+        stats.add(Counter::PacketsSent);
+        finishTx(true);
+        return;
+    }
+
+    const double bytesPerSecond = baudRate / 10.0;
+    const size_t chunkSize = std::max<size_t>(1, static_cast<size_t>(bytesPerSecond * params.txChunkMs / 1000.0));
+
+    size_t written = sendPort->write(txRaw.subspan(txSent, std::min(chunkSize, txRaw.size() - txSent)));
+    if (written == 0) {
+        Trace::emit(Trace::Event::TxEnd, traceChannel);
+        finishTx(false);
+        return;
+    }
+    txSent += written;
+
+    auto deadline = txStart + duration_cast<Timing::Clock::duration>(duration<double>(txSent / bytesPerSecond));
+    setTimer(deadline, [this] { transmitNextChunk(); });
+}
+
+void AsyncLink::onCollision() {
+    cancelTimer();
+    Trace::emit(Trace::Event::TxEnd, traceChannel);
+    stats.add(Counter::Collisions);
+    Trace::emit(Trace::Event::Collision, traceChannel);
+
+    std::vector<uint8_t> jam(params.jamLength, CSMA::JAM);
+    sendPort->write(jam);
+    stats.add(Counter::JamSent);
+    Trace::emit(Trace::Event::JamSent, traceChannel);
+
+    finishTx(false);
+}
+
+// --- СООБЩЕНИЯ ---
+
+void AsyncLink::send(std::string message, Done done) {
+    if (!isOpen()) {
+        reactor.post([done = std::move(done)] { if (done) done(false); });
+        return;
+    }
+    Outgoing out;
+    std::string packed;
+    out.compressed = compression && Lz::compress(
+        std::span<const uint8_t>(reinterpret_cast<const uint8_t*>(message.data()), message.size()), packed);
+    out.message = out.compressed ? std::move(packed) : std::move(message);
+    out.done = std::move(done);
+    enqueue(std::move(out));
+}
+
+void AsyncLink::sendFrames(std::vector<std::vector<uint8_t>> frames, Done done) {
+    if (!isOpen()) {
+        reactor.post([done = std::move(done)] { if (done) done(false); });
+        return;
+    }
+    Outgoing out;
+    out.frames = std::move(frames);
+    out.done = std::move(done);
+    enqueue(std::move(out));
+}
+
+void AsyncLink::enqueue(Outgoing&& out) {
+    bool idle = outbox.empty();
+    outbox.push_back(std::move(out));
+    if (idle) {
+        // Начинаем из цикла событий: завершение не придет внутри send()
+        defer([this] { startNextFrame(); });
+    }
+}
+
+void AsyncLink::startNextFrame() {
+    if (outbox.empty()) return;
+    Outgoing& out = outbox.front();
+    frameAttempts = 0;
+    frameReady = Timing::Clock::now();
+
+    if (!out.frames.empty() || out.message.empty()) {
+        if (out.nextFrame >= out.frames.size()) {
+            finishMessage(true);
+            return;
+        }
+        txCurrent = out.frames[out.nextFrame];
+        Trace::emit(Trace::Event::FrameEnqueued, traceChannel, static_cast<uint32_t>(out.nextFrame));
+        attemptFrame();
+        return;
+    }
+    if (out.offset >= out.message.size()) {
+        finishMessage(true);
+        return;
+    }
+
+    txFrameLen = payloadSizer.next(out.message.size() - out.offset);
+    txFrame.sender = Transport::portNumber(sendPortName);
+    txFrame.receiver = Transport::portNumber(receivePortName);
+    txFrame.timestamp = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+    txFrame.seqNumber = static_cast<uint8_t>(txFrame.seqNumber + 1);
+    txFrame.dataLen = static_cast<uint16_t>(txFrameLen);
+    txFrame.setCompressed(out.compressed);
+    txFrame.data.assign(std::span<const uint8_t>(
+        reinterpret_cast<const uint8_t*>(out.message.data()) + out.offset, txFrameLen));
+
+    txBuffer.resize(Frame::max_encoded_size(txFrameLen));
+    txCurrent = std::span<const uint8_t>(txBuffer.data(), txFrame.encode_into(txBuffer, &txHeaders));
+    Trace::emit(Trace::Event::FrameEnqueued, traceChannel, txFrame.seqNumber);
+    attemptFrame();
+}
+
+void AsyncLink::attemptFrame() {
+    acquire([this](bool free) {
+        if (!free) {
+            finishMessage(false);
+            return;
+        }
+        transmit(txCurrent, [this](bool sent) {
+            if (!isOpen()) {
+                finishMessage(false);
+                return;
+            }
+            if (sent) {
+                auto now = Timing::Clock::now();
+                stats.recordDuration(Histogram::AccessDelay, txStart - frameReady);
+                stats.recordDuration(Histogram::FrameLatency, now - frameReady);
+                stats.record(Histogram::Attempts, frameAttempts + 1);
+
+                Outgoing& out = outbox.front();
+                if (out.frames.empty()) {
+                    payloadSizer.onFrameResult(txCurrent.size(), frameAttempts, 0);
+                    out.offset += txFrameLen;
+                }
+                else {
+                    out.nextFrame++;
+                }
+                startNextFrame();
+                return;
+            }
+            frameAttempts++;
+            if (frameAttempts >= params.maxAttempts) {
+                stats.record(Histogram::Attempts, frameAttempts);
+                finishMessage(false);
+                return;
+            }
+            auto delay = backoff->collisionDelaySlots(frameAttempts) * std::chrono::milliseconds(params.slotTimeMs);
+            stats.recordDuration(Histogram::BackoffDelay, delay);
+            Trace::emit(Trace::Event::BackoffBegin, traceChannel, Trace::micros(delay));
+            txState = TxState::Waiting;
+            setTimer(Timing::Clock::now() + delay, [this] {
+                Trace::emit(Trace::Event::BackoffEnd, traceChannel);
+                txState = TxState::Idle;
+                attemptFrame();
+            });
+        });
+    });
+}
+
+void AsyncLink::finishMessage(bool ok) {
+    if (outbox.empty()) return;
+    // Кадр, который не ушел, мог быть опорным для сжатых заголовков
+    if (!ok) txHeaders.reset();
+    Done done = std::move(outbox.front().done);
+    outbox.pop_front();
+
+    // Сначала завершение этого сообщения, потом следующее: пустое следующее
+    // завершилось бы сразу, раньше текущего. Обработчик может закрыть или
+    // удалить линию — тогда очередь уже не наша. Если очередь опустела,
+    // новое сообщение из обработчика запустит enqueue
+    bool more = !outbox.empty();
+    std::weak_ptr<int> alive = lifetime;
+    uint64_t closes = closeCount;
+    if (done) done(ok);
+    if (more && alive.lock() && closeCount == closes) startNextFrame();
+}
+
+// --- ПРИЕМ ---
+
+void AsyncLink::onReceivePortReadable() {
+    for (int i = 0; i < MAX_READS_PER_EVENT && receivePort; ++i) {
+        size_t got = receivePort->receiveUntil([line = line.get()](std::span<const uint8_t> bytes) {
+            line->feed(bytes);
+        }, Timing::Clock::now());
+        if (got == 0) break;
+    }
+}
+
+void AsyncLink::deliver(Frame& frame) {
+    if (!frameWaiters.empty()) {
+        PendingReceive pending = std::move(frameWaiters.front());
+        frameWaiters.pop_front();
+        if (pending.timer != 0) reactor.cancelTimer(pending.timer);
+        pending.waiter(std::move(frame));
+        return;
+    }
+    if (frameHandler) {
+        frameHandler(frame);
+        return;
+    }
+    if (inbox.size() >= RX_QUEUE_CAPACITY) {
+        stats.add(Counter::QueueOverflows);
+        return;
+    }
+    inbox.push_back(std::move(frame));
+}
+
+void AsyncLink::setFrameHandler(FrameHandler handler) {
+    frameHandler = std::move(handler);
+}
+
+void AsyncLink::setRawFrameHandler(FrameHandler handler) {
+    rawFrameHandler = std::move(handler);
+}
+
+void AsyncLink::receive(FrameWaiter waiter, Timing::Clock::time_point deadline) {
+    if (!inbox.empty()) {
+        auto frame = std::make_shared<Frame>(std::move(inbox.front()));
+        inbox.pop_front();
+        reactor.post([waiter = std::move(waiter), frame] { waiter(std::move(*frame)); });
+        return;
+    }
+    if (!isOpen()) {
+        reactor.post([waiter = std::move(waiter)] { waiter(std::nullopt); });
+        return;
+    }
+
+    PendingReceive pending{ std::move(waiter), nextReceiveId++ };
+    if (deadline != Timing::NO_DEADLINE) {
+        pending.timer = reactor.addTimer(deadline, [this, id = pending.id] {
+            auto it = std::find_if(frameWaiters.begin(), frameWaiters.end(),
+                [id](const PendingReceive& p) { return p.id == id; });
+            if (it == frameWaiters.end()) return;
+            FrameWaiter expired = std::move(it->waiter);
+            frameWaiters.erase(it);
+            expired(std::nullopt);
+        });
+    }
+    frameWaiters.push_back(std::move(pending));
+}
+
+// --- СОПРОГРАММЫ ---
+
+CallbackAwaiter<bool> AsyncLink::acquireChannel() {
+    return CallbackAwaiter<bool>([this](Done done) { acquire(std::move(done)); });
+}
+
+CallbackAwaiter<bool> AsyncLink::transmitFrame(std::span<const uint8_t> raw) {
+    return CallbackAwaiter<bool>([this, raw](Done done) { transmit(raw, std::move(done)); });
+}
+
+CallbackAwaiter<bool> AsyncLink::sendMessage(std::string message) {
+    return CallbackAwaiter<bool>([this, message = std::move(message)](Done done) mutable {
+        send(std::move(message), std::move(done));
+    });
+}
+
+CallbackAwaiter<std::optional<Frame>> AsyncLink::receiveFrame(Timing::Clock::time_point deadline) {
+    return CallbackAwaiter<std::optional<Frame>>([this, deadline](FrameWaiter waiter) { receive(std::move(waiter), deadline); });
+}
+
+#endif
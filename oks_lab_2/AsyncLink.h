@@ -0,0 +1,220 @@
+#pragma once
+#ifdef __linux__
+#include <coroutine>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <random>
+#include <span>
+#include <string>
+#include <vector>
+#include "Backoff.h"
+#include "ChannelNoise.h"
+#include "CsmaConfig.h"
+#include "Frame.h"
+#include "LineReceiver.h"
+#include "PayloadSizer.h"
+#include "Reactor.h"
+#include "StatsRecorder.h"
+#include "Trace.h"
+#include "Transport.h"
+
+//   ,      
+//    : co_await      
+struct AsyncTask {
+    struct promise_type {
+        AsyncTask get_return_object() noexcept { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() { std::terminate(); }
+    };
+};
+
+// co_await     : start  ,
+//     .    
+//   start,     
+template<typename T>
+class CallbackAwaiter {
+public:
+    using Start = std::function<void(std::function<void(T)>)>;
+
+    explicit CallbackAwaiter(Start start) : start(std::move(start)) {}
+
+    bool await_ready() const noexcept { return false; }
+
+    void await_suspend(std::coroutine_handle<> handle) {
+        start([this, handle](T value) {
+            result.emplace(std::move(value));
+            handle.resume();
+        });
+    }
+
+    T await_resume() { return std::move(*result); }
+
+private:
+    Start start;
+    std::optional<T> result;
+};
+
+//   (/)   Reactor.   CSMA/CD, 
+//  COMPortManager::sendFrameCsma,       
+//    ,   :   
+//   .   (ARQ)   .
+//
+//       (    
+// Reactor::post).      .
+class AsyncLink {
+public:
+    using Done = std::function<void(bool ok)>;
+    using FrameHandler = std::function<void(Frame&)>;
+    using FrameWaiter = std::function<void(std::optional<Frame>)>;
+
+    static const size_t RX_QUEUE_CAPACITY = 1024;
+
+    AsyncLink(Reactor& reactor, const CSMA::Params& params = CSMA::Params(), uint32_t seed = std::random_device{}());
+    ~AsyncLink();
+
+    AsyncLink(const AsyncLink&) = delete;
+    AsyncLink& operator=(const AsyncLink&) = delete;
+
+    // false          epoll (COM- Win32)
+    bool open(const std::string& sendPortName, const std::string& receivePortName, uint32_t baudRate);
+    //    false,     
+    void close();
+    bool isOpen() const { return sendPort && receivePort; }
+
+    //  : ENQ  ACK   ,     .
+    // false   
+    void acquire(Done done);
+    //     . false   (JAM  ).
+    // raw     
+    void transmit(std::span<const uint8_t> raw, Done done);
+    //      .     
+    void send(std::string message, Done done);
+    //       (Frame::encode_into)
+    void sendFrames(std::vector<std::vector<uint8_t>> frames, Done done);
+
+    //    ;        receive
+    void setFrameHandler(FrameHandler handler);
+    //   :    ,   FEC
+    //   .      
+    void setRawFrameHandler(FrameHandler handler);
+    //   ;     deadline   .
+    //  ARQ   ,        
+    void receive(FrameWaiter waiter, Timing::Clock::time_point deadline = Timing::NO_DEADLINE);
+
+    CallbackAwaiter<bool> acquireChannel();
+    CallbackAwaiter<bool> transmitFrame(std::span<const uint8_t> raw);
+    CallbackAwaiter<bool> sendMessage(std::string message);
+    CallbackAwaiter<std::optional<Frame>> receiveFrame(Timing::Clock::time_point deadline = Timing::NO_DEADLINE);
+
+    //     
+    CSMA::Stats getStats() const { return stats.snapshot().totals; }
+    CSMA::StatsSnapshot getSnapshot() const { return stats.snapshot(); }
+    PayloadSizer& getPayloadSizer() { return payloadSizer; }
+    //   ,     COMPortManager
+    void setNoise(const ChannelNoise::Model& model) { noise = model; }
+    //  FCS ,   sendMessage
+    void setFecMode(FecMode mode) { txFrame.setFecMode(mode); }
+    // CRC-32C  ,   sendMessage
+    void setCrc(bool on) { txFrame.setCrc(on); }
+    //   sendMessage (Lz);    
+    void setCompression(bool on) { compression = on; }
+    //    sendMessage
+    void setCompactHeader(bool on) { txFrame.setCompactHeader(on); }
+
+private:
+    enum class TxState {
+        Idle,
+        Listening,    // ENQ ,  ACK   
+        Waiting,      //     
+        Transmitting  //     
+    };
+
+    // ,       ,   
+    struct Outgoing {
+        std::string message;
+        bool compressed = false;    // message   Lz
+        size_t offset = 0;
+        std::vector<std::vector<uint8_t>> frames;
+        size_t nextFrame = 0;
+        Done done;
+    };
+
+    Reactor& reactor;
+    CSMA::Params params;
+    std::unique_ptr<BackoffStrategy> backoff;
+    std::mt19937 rng;
+
+    std::unique_ptr<Transport> sendPort;
+    std::unique_ptr<Transport> receivePort;
+    std::string sendPortName;
+    std::string receivePortName;
+    uint32_t baudRate = 9600;
+    uint16_t traceChannel = 0;
+
+    // 
+    TxState txState = TxState::Idle;
+    Reactor::TimerId txTimer = 0;
+    Timing::Clock::time_point slotEnd;
+    Done txDone;
+    std::span<const uint8_t> txRaw;
+    size_t txSent = 0;
+    Timing::Clock::time_point txStart;
+
+    std::deque<Outgoing> outbox;
+    uint64_t closeCount = 0;    // close()     
+    Frame txFrame;
+    std::vector<uint8_t> txBuffer;
+    CompactHeader::Encoder txHeaders;
+    bool compression = false;
+    size_t txFrameLen = 0;
+    std::span<const uint8_t> txCurrent;    // ,   
+    int frameAttempts = 0; //   
+    Timing::Clock::time_point frameReady;  //      
+
+    // 
+    std::shared_ptr<LineReceiver> line;
+    ChannelNoise::Model noise = ChannelNoise::Model::lab();
+    FrameHandler frameHandler;
+    FrameHandler rawFrameHandler;
+    struct PendingReceive {
+        FrameWaiter waiter;
+        uint64_t id = 0;
+        Reactor::TimerId timer = 0;
+    };
+    std::deque<PendingReceive> frameWaiters;
+    uint64_t nextReceiveId = 1;
+    std::deque<Frame> inbox;
+
+    PayloadSizer payloadSizer;
+    CSMA::StatsRecorder stats;
+
+    //   ,    
+    std::shared_ptr<int> lifetime = std::make_shared<int>(0);
+    void defer(Reactor::Callback callback);
+
+    void setTimer(Timing::Clock::time_point when, Reactor::Callback callback);
+    void cancelTimer();
+    void finishTx(bool ok);
+
+    void startListening();
+    void onSendPortReadable();
+    void onReceivePortReadable();
+    void onAck();
+    void onSlotExpired();
+    void transmitNextChunk();
+    void onCollision();
+
+    void startNextFrame();
+    void attemptFrame();
+    void finishMessage(bool ok);
+
+    void enqueue(Outgoing&& out);
+    void deliver(Frame& frame);
+};
+#endif
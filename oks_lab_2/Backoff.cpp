@@ -0,0 +1,20 @@
+﻿#include "Backoff.h"
+
+std::unique_ptr<BackoffStrategy> BackoffStrategy::create(const CSMA::Params& params, uint64_t seed) {
+    switch (params.backoff) {
+    case CSMA::BackoffKind::OnePersistent:
+        return std::make_unique<OnePersistentBackoff>(params.maxBackoffLimit, seed);
+    case CSMA::BackoffKind::PPersistent:
+        return std::make_unique<PPersistentBackoff>(params.maxBackoffLimit, params.persistence, seed);
+    case CSMA::BackoffKind::BoundedJitter:
+        return std::make_unique<BoundedJitterBackoff>(params.jitterSlots, seed);
+    default:
+        return std::make_unique<TruncatedBinaryBackoff>(params.maxBackoffLimit, seed);
+    }
+}
+
+std::unique_ptr<BackoffStrategy> BackoffStrategy::create(const CSMA::Params& params) {
+    std::random_device rd;
+    uint64_t seed = (static_cast<uint64_t>(rd()) << 32) ^ rd();
+    return create(params, seed);
+}
@@ -0,0 +1,79 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <random>
+#include "CsmaConfig.h"
+
+//    .     ,
+//         .
+class BackoffStrategy {
+public:
+    virtual ~BackoffStrategy() = default;
+
+    //  :      
+    virtual bool shouldTransmit() { return true; }
+
+    //  :      (0  )
+    virtual int busyDelaySlots() = 0;
+
+    //     attempts-  
+    virtual int collisionDelaySlots(int attempts) = 0;
+
+    virtual const char* name() const = 0;
+
+    static std::unique_ptr<BackoffStrategy> create(const CSMA::Params& params, uint64_t seed);
+    static std::unique_ptr<BackoffStrategy> create(const CSMA::Params& params);
+
+protected:
+    explicit BackoffStrategy(uint64_t seed) : rng(static_cast<std::mt19937::result_type>(seed ^ (seed >> 32))) {}
+
+    std::mt19937 rng;
+};
+
+//     (  sendMessage )
+class TruncatedBinaryBackoff : public BackoffStrategy {
+public:
+    TruncatedBinaryBackoff(int limit, uint64_t seed) : BackoffStrategy(seed), limit(limit) {}
+
+    int busyDelaySlots() override { return 1; }
+    int collisionDelaySlots(int attempts) override { return CSMA::backoff_slots(attempts, limit, rng()); }
+    const char* name() const override { return "beb"; }
+
+private:
+    int limit;
+};
+
+// 1- :    
+class OnePersistentBackoff : public TruncatedBinaryBackoff {
+public:
+    using TruncatedBinaryBackoff::TruncatedBinaryBackoff;
+
+    int busyDelaySlots() override { return 0; }
+    const char* name() const override { return "1-persistent"; }
+};
+
+// p- :       p
+class PPersistentBackoff : public TruncatedBinaryBackoff {
+public:
+    PPersistentBackoff(int limit, double p, uint64_t seed) : TruncatedBinaryBackoff(limit, seed), persistence(p) {}
+
+    bool shouldTransmit() override { return std::uniform_real_distribution<double>(0.0, 1.0)(rng) < persistence; }
+    int busyDelaySlots() override { return 0; }
+    const char* name() const override { return "p-persistent"; }
+
+private:
+    double persistence;
+};
+
+//   :     0..bound   
+class BoundedJitterBackoff : public BackoffStrategy {
+public:
+    BoundedJitterBackoff(int bound, uint64_t seed) : BackoffStrategy(seed), bound(bound) {}
+
+    int busyDelaySlots() override { return std::uniform_int_distribution<int>(0, 1)(rng); }
+    int collisionDelaySlots(int) override { return std::uniform_int_distribution<int>(0, bound)(rng); }
+    const char* name() const override { return "jitter"; }
+
+private:
+    int bound;
+};
@@ -0,0 +1,241 @@
+﻿#include "Crc32c.h"
+#include "Frame.h"
+#include "FrameParser.h"
+#include "HammingBlock.h"
+#include "Lz.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Микробенчмарки кадрирования и FEC: время на кадр и пропускная способность
+// по данным для размеров от 1 байта до максимального кадра (65535 байт).
+// oks_bench [--sizes 1,64,4096] [--filter имя] [--min-time мс] [--repeat N] [--csv]
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    struct Options {
+        std::vector<size_t> sizes{ 1, 4, 16, 64, 256, 1024, 4096, 16384, 65535 };
+        std::string filter;
+        double minTimeMs = 200.0;
+        int repeat = 5;
+        bool csv = false;
+    };
+
+    // Не дает компилятору выбросить результат
+    volatile size_t sink = 0;
+
+    struct Input {
+        Frame frame;
+        std::vector<uint8_t> data;
+        std::vector<uint8_t> fcs;
+        std::vector<uint8_t> fcsBlocked;
+        std::vector<uint8_t> fcsInterleaved;
+        std::vector<uint8_t> raw;
+        std::vector<uint8_t> corrupted;   // data с одной ошибкой
+        std::vector<uint8_t> text;        // сжимаемые данные того же размера
+        std::string packed;               // text после Lz::compress
+    };
+
+    Input make_input(size_t size, std::mt19937& rng) {
+        Input in;
+        in.data.resize(size);
+        for (auto& b : in.data) b = static_cast<uint8_t>(rng());
+
+        in.frame.sender = 1;
+        in.frame.receiver = 2;
+        in.frame.timestamp = 0x0102030405060708ULL;
+        in.frame.seqNumber = 7;
+        in.frame.dataLen = static_cast<uint16_t>(size);
+        in.frame.data.assign(std::span<const uint8_t>(in.data));
+
+        in.fcs = HammingBlock::generate_fcs(in.data);
+        for (FecMode mode : { FecMode::Blocked, FecMode::Interleaved }) {
+            std::vector<uint8_t>& fcs = mode == FecMode::Blocked ? in.fcsBlocked : in.fcsInterleaved;
+            fcs.resize(HammingBlock::fcs_size(size, mode));
+            HammingBlock::generate_fcs_into(in.data, fcs, mode);
+        }
+        in.frame.fcs.assign(std::span<const uint8_t>(in.fcs));
+        in.raw = in.frame.create_frame();
+
+        in.corrupted = in.data;
+        in.corrupted[size / 2] ^= 0x10;
+
+        static const char* const words[] = { "кадр ", "канал ", "коллизия ", "frame ", "ACK ", "CSMA/CD ", "115200 ", "\n" };
+        std::string text;
+        while (text.size() < size) text += words[rng() % std::size(words)];
+        in.text.assign(text.begin(), text.begin() + size);
+        Lz::compress(in.text, in.packed);
+        return in;
+    }
+
+    struct Case {
+        const char* name;
+        std::function<void(Input&)> run;
+    };
+
+    std::vector<Case> make_cases() {
+        return {
+            { "create_frame", [](Input& in) { sink = sink + in.frame.create_frame().size(); } },
+            { "encode_into", [](Input& in) {
+                static thread_local std::vector<uint8_t> out;
+                out.resize(Frame::max_encoded_size(in.data.size()));
+                sink = sink + in.frame.encode_into(out);
+            } },
+            { "encode_compact", [](Input& in) {
+                // Сжатый заголовок с состоянием линии: опорный кадр раз в REFRESH_FRAMES
+                static thread_local std::vector<uint8_t> out;
+                static thread_local CompactHeader::Encoder headers;
+                out.resize(Frame::max_encoded_size(in.data.size()));
+                in.frame.setCompactHeader(true);
+                sink = sink + in.frame.encode_into(out, &headers);
+                in.frame.setCompactHeader(false);
+            } },
+            { "de_byte_stuffing", [](Input& in) {
+                Frame parsed;
+                sink = sink + Frame::de_byte_stuffing(in.raw, parsed) + parsed.data.size();
+            } },
+            { "frame_parser", [](Input& in) {
+                // Потоковый разбор с передачей кадра потребителю: буферы длинных
+                // кадров возвращаются в пул разборщика и не берутся из кучи заново
+                static thread_local Frame taken;
+                static thread_local FrameParser parser([](Frame& f) { taken = std::move(f); });
+                parser.feed(in.raw);
+                sink = sink + taken.data.size();
+                taken = Frame();
+            } },
+            { "crc32c", [](Input& in) { sink = sink + Crc32c::compute(in.data); } },
+            { "lz_compress_text", [](Input& in) {
+                static thread_local std::string out;
+                sink = sink + Lz::compress(in.text, out) + out.size();
+            } },
+            { "lz_compress_random", [](Input& in) {
+                // Несжимаемые данные: важно, как быстро компрессор сдается
+                static thread_local std::string out;
+                sink = sink + Lz::compress(in.data, out) + out.size();
+            } },
+            { "lz_decompress_text", [](Input& in) {
+                static thread_local std::string out;
+                out.clear();
+                sink = sink + Lz::decompress(std::span<const uint8_t>(
+                    reinterpret_cast<const uint8_t*>(in.packed.data()), in.packed.size()), out);
+            } },
+            { "generate_fcs", [](Input& in) { sink = sink + HammingBlock::generate_fcs(in.data).size(); } },
+            { "generate_fcs_into", [](Input& in) {
+                uint8_t fcs[Frame::INLINE_FCS_SIZE];
+                sink = sink + HammingBlock::generate_fcs_into(in.data, fcs);
+            } },
+            { "decode_and_correct", [](Input& in) {
+                HammingBlockResult r = HammingBlock::decode_and_correct(in.corrupted, in.fcs);
+                sink = sink + r.corrected_data.size() + r.single_error_corrected;
+            } },
+            { "correct_in_place", [](Input& in) {
+                // Ошибка вносится заново: исправление возвращает данные к исходным
+                in.data[in.data.size() / 2] ^= 0x10;
+                sink = sink + static_cast<size_t>(HammingBlock::correct_in_place(in.data, in.fcs));
+            } },
+            { "fcs_blocked", [](Input& in) {
+                sink = sink + HammingBlock::generate_fcs_into(in.data, in.fcsBlocked, FecMode::Blocked);
+            } },
+            { "correct_blocked", [](Input& in) {
+                in.data[in.data.size() / 2] ^= 0x10;
+                sink = sink + static_cast<size_t>(HammingBlock::correct_in_place(in.data, in.fcsBlocked, FecMode::Blocked));
+            } },
+            { "fcs_interleaved", [](Input& in) {
+                sink = sink + HammingBlock::generate_fcs_into(in.data, in.fcsInterleaved, FecMode::Interleaved);
+            } },
+            { "correct_interleaved", [](Input& in) {
+                in.data[in.data.size() / 2] ^= 0x10;
+                sink = sink + static_cast<size_t>(HammingBlock::correct_in_place(in.data, in.fcsInterleaved, FecMode::Interleaved));
+            } },
+        };
+    }
+
+    // Медиана нескольких замеров; в каждом операция повторяется, пока не пройдет minTimeMs
+    double measure_ns(const Case& c, Input& in, const Options& opt) {
+        for (int i = 0; i < 3; ++i) c.run(in);
+
+        std::vector<double> samples;
+        for (int r = 0; r < opt.repeat; ++r) {
+            size_t iterations = 0;
+            size_t batch = 1;
+            auto start = Clock::now();
+            double elapsedMs = 0.0;
+            while (elapsedMs < opt.minTimeMs) {
+                for (size_t i = 0; i < batch; ++i) c.run(in);
+                iterations += batch;
+                batch = std::min<size_t>(batch * 2, 1 << 16);
+                elapsedMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+            }
+            samples.push_back(elapsedMs * 1e6 / iterations);
+        }
+        std::sort(samples.begin(), samples.end());
+        return samples[samples.size() / 2];
+    }
+
+    bool parse_options(int argc, char** argv, Options& opt) {
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg == "--csv") { opt.csv = true; continue; }
+
+            const char* value = (i + 1 < argc) ? argv[i + 1] : nullptr;
+            if (!value) { std::cerr << "Нет значения для " << arg << std::endl; return false; }
+            ++i;
+
+            if (arg == "--filter") opt.filter = value;
+            else if (arg == "--min-time") opt.minTimeMs = std::max(1.0, std::atof(value));
+            else if (arg == "--repeat") opt.repeat = std::max(1, std::atoi(value));
+            else if (arg == "--sizes") {
+                opt.sizes.clear();
+                std::istringstream list(value);
+                for (std::string item; std::getline(list, item, ',');) {
+                    size_t size = std::strtoull(item.c_str(), nullptr, 10);
+                    if (size == 0 || size > 65535) { std::cerr << "Размер вне 1..65535: " << item << std::endl; return false; }
+                    opt.sizes.push_back(size);
+                }
+            }
+            else { std::cerr << "Неизвестный параметр " << arg << std::endl; return false; }
+        }
+        return true;
+    }
+}
+
+int main(int argc, char** argv) {
+    Options opt;
+    if (!parse_options(argc, argv, opt)) return 1;
+
+    std::mt19937 rng(12345);
+    std::vector<Input> inputs;
+    for (size_t size : opt.sizes) {
+        inputs.push_back(make_input(size, rng));
+    }
+
+    if (opt.csv) std::cout << "case,bytes,ns_per_frame,mb_per_s" << std::endl;
+    else std::cout << std::left << std::setw(20) << "case" << std::right << std::setw(8) << "bytes"
+                   << std::setw(14) << "ns/frame" << std::setw(12) << "MB/s" << std::endl;
+
+    for (const Case& c : make_cases()) {
+        if (!opt.filter.empty() && std::string(c.name).find(opt.filter) == std::string::npos) continue;
+        for (Input& in : inputs) {
+            double ns = measure_ns(c, in, opt);
+            double mbps = in.data.size() / ns * 1e9 / (1024.0 * 1024.0);
+            if (opt.csv) {
+                std::cout << c.name << "," << in.data.size() << "," << std::fixed << std::setprecision(1)
+                          << ns << "," << std::setprecision(2) << mbps << std::endl;
+            }
+            else {
+                std::cout << std::left << std::setw(20) << c.name << std::right << std::setw(8) << in.data.size()
+                          << std::fixed << std::setprecision(1) << std::setw(14) << ns
+                          << std::setprecision(2) << std::setw(12) << mbps << std::endl;
+            }
+        }
+    }
+    return 0;
+}
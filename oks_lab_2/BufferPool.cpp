@@ -0,0 +1,84 @@
+﻿#include "BufferPool.h"
+#include <atomic>
+#include <bit>
+#include <new>
+#include "MpscQueue.h"
+
+namespace {
+    const size_t CLASSES = std::countr_zero(BufferPool::MAX_BLOCK) - std::countr_zero(BufferPool::MIN_BLOCK) + 1;
+
+    uint8_t size_class(size_t n) {
+        size_t rounded = n <= BufferPool::MIN_BLOCK ? BufferPool::MIN_BLOCK : std::bit_ceil(n);
+        return static_cast<uint8_t>(std::countr_zero(rounded) - std::countr_zero(BufferPool::MIN_BLOCK));
+    }
+
+    void destroy(BufferPool::Block* block) {
+        ::operator delete(block);
+    }
+}
+
+// Общее состояние: живет, пока жив пул или хотя бы один выданный блок
+struct BufferPool::Core {
+    std::atomic<size_t> refs{ 1 };
+    std::atomic<bool> closed{ false };   // пул уничтожен, блоки больше не копятся
+    MpscQueue<Block*, FREE_BLOCKS> free[CLASSES];
+    std::atomic<uint64_t> allocated{ 0 };
+    std::atomic<uint64_t> reused{ 0 };
+
+    ~Core() {
+        // Ссылок не осталось: очереди никто больше не трогает
+        Block* block;
+        for (auto& queue : free) {
+            while (queue.pop(block)) destroy(block);
+        }
+    }
+
+    void unref() {
+        if (refs.fetch_sub(1, std::memory_order_acq_rel) == 1) delete this;
+    }
+};
+
+BufferPool::BufferPool() : core(new Core) {
+}
+
+BufferPool::~BufferPool() {
+    core->closed.store(true, std::memory_order_release);
+    Block* block;
+    for (auto& queue : core->free) {
+        while (queue.pop(block)) destroy(block);
+    }
+    core->unref();
+}
+
+BufferPool::Block* BufferPool::acquire(size_t n) {
+    if (n > MAX_BLOCK) return nullptr;
+    uint8_t cls = size_class(n);
+
+    Block* block;
+    if (core->free[cls].pop(block)) {
+        core->reused.fetch_add(1, std::memory_order_relaxed);
+    }
+    else {
+        size_t bytes = MIN_BLOCK << cls;
+        block = new (::operator new(sizeof(Block) + bytes)) Block{ core, static_cast<uint32_t>(bytes), cls };
+        core->allocated.fetch_add(1, std::memory_order_relaxed);
+    }
+    core->refs.fetch_add(1, std::memory_order_relaxed);
+    return block;
+}
+
+void BufferPool::release(Block* block) {
+    Core* owner = block->core;
+    if (owner->closed.load(std::memory_order_acquire) || !owner->free[block->sizeClass].push(std::move(block))) {
+        destroy(block);
+    }
+    owner->unref();
+}
+
+uint64_t BufferPool::allocatedCount() const {
+    return core->allocated.load(std::memory_order_relaxed);
+}
+
+uint64_t BufferPool::reusedCount() const {
+    return core->reused.load(std::memory_order_relaxed);
+}
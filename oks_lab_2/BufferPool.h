@@ -0,0 +1,48 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+
+//       .   64  - 64 
+// ( )     ,   ,   
+//  ,   .    
+//     ,     
+//       .
+//         :  
+//  ,   .
+class BufferPool {
+    struct Core;
+
+public:
+    static const size_t MIN_BLOCK = 64;
+    static const size_t MAX_BLOCK = 65536;
+    //       ,  
+    static const size_t FREE_BLOCKS = 128;
+
+    struct Block {
+        Core* core;
+        uint32_t capacity;
+        uint8_t sizeClass;
+    };
+
+    BufferPool();
+    ~BufferPool();
+
+    BufferPool(const BufferPool&) = delete;
+    BufferPool& operator=(const BufferPool&) = delete;
+
+    //    n ; nullptr  n  MAX_BLOCK.  -
+    Block* acquire(size_t n);
+
+    //     ;   
+    static void release(Block* block);
+
+    static uint8_t* bytes(Block* block) { return reinterpret_cast<uint8_t*>(block + 1); }
+    static size_t capacity(const Block* block) { return block->capacity; }
+
+    //          
+    uint64_t allocatedCount() const;
+    uint64_t reusedCount() const;
+
+private:
+    Core* core;
+};
@@ -0,0 +1,213 @@
+﻿#include "ByteStuffing.h"
+#include "CpuFeatures.h"
+#include <bit>
+#include <cstring>
+
+#if OKS_ARCH_X86
+#include <immintrin.h>
+#endif
+
+namespace {
+    using namespace ByteStuffing;
+
+    using StuffFn = size_t(*)(const uint8_t*, size_t, uint8_t*);
+    using UnstuffFn = bool(*)(const uint8_t*, size_t, uint8_t*, size_t&);
+
+    bool needs_escape(uint8_t b) {
+        return b == START_FLAG || b == ESC || b == END_FLAG;
+    }
+
+    // --- Скалярные версии (и хвосты векторных) ---
+
+    size_t stuff_tail(const uint8_t* in, size_t n, size_t i, uint8_t* out, size_t w) {
+        for (; i < n; ++i) {
+            uint8_t b = in[i];
+            if (needs_escape(b)) {
+                out[w++] = ESC;
+                out[w++] = b ^ 0x20;
+            }
+            else {
+                out[w++] = b;
+            }
+        }
+        return w;
+    }
+
+    bool unstuff_tail(const uint8_t* in, size_t n, size_t i, uint8_t* out, size_t w, size_t& written) {
+        while (i < n) {
+            uint8_t b = in[i++];
+            if (b == END_FLAG) break; // Конец кадра
+
+            if (b == ESC) {
+                if (i >= n) {
+                    written = w;
+                    return false;
+                }
+                b = in[i++] ^ 0x20;
+            }
+            out[w++] = b;
+        }
+        written = w;
+        return true;
+    }
+
+    size_t stuff_scalar(const uint8_t* in, size_t n, uint8_t* out) {
+        return stuff_tail(in, n, 0, out, 0);
+    }
+
+    bool unstuff_scalar(const uint8_t* in, size_t n, uint8_t* out, size_t& written) {
+        return unstuff_tail(in, n, 0, out, 0, written);
+    }
+
+#if OKS_ARCH_X86
+    // Блок копируется в выход целиком, затем указатель записи сдвигается только
+    // на чистый префикс до первого служебного байта. Запись не выходит за границы:
+    // при стаффинге w <= 2i, при снятии стаффинга w <= i.
+
+    OKS_TARGET("sse2")
+    size_t stuff_sse2(const uint8_t* in, size_t n, uint8_t* out) {
+        const __m128i start = _mm_set1_epi8(static_cast<char>(START_FLAG));
+        const __m128i esc = _mm_set1_epi8(static_cast<char>(ESC));
+        const __m128i end = _mm_set1_epi8(static_cast<char>(END_FLAG));
+
+        size_t i = 0, w = 0;
+        while (i + 16 <= n) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+            __m128i hit = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, start), _mm_cmpeq_epi8(v, esc)), _mm_cmpeq_epi8(v, end));
+            unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(hit));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + w), v);
+            if (mask == 0) {
+                i += 16;
+                w += 16;
+                continue;
+            }
+            unsigned k = static_cast<unsigned>(std::countr_zero(mask));
+            w += k;
+            out[w++] = ESC;
+            out[w++] = in[i + k] ^ 0x20;
+            i += k + 1;
+        }
+        return stuff_tail(in, n, i, out, w);
+    }
+
+    OKS_TARGET("sse2")
+    bool unstuff_sse2(const uint8_t* in, size_t n, uint8_t* out, size_t& written) {
+        const __m128i esc = _mm_set1_epi8(static_cast<char>(ESC));
+        const __m128i end = _mm_set1_epi8(static_cast<char>(END_FLAG));
+
+        size_t i = 0, w = 0;
+        while (i + 16 <= n) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+            __m128i hit = _mm_or_si128(_mm_cmpeq_epi8(v, esc), _mm_cmpeq_epi8(v, end));
+            unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(hit));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + w), v);
+            if (mask == 0) {
+                i += 16;
+                w += 16;
+                continue;
+            }
+            unsigned k = static_cast<unsigned>(std::countr_zero(mask));
+            w += k;
+            i += k;
+            if (in[i] == END_FLAG) {
+                written = w;
+                return true;
+            }
+            if (i + 1 >= n) {
+                written = w;
+                return false;
+            }
+            out[w++] = in[i + 1] ^ 0x20;
+            i += 2;
+        }
+        return unstuff_tail(in, n, i, out, w, written);
+    }
+
+    OKS_TARGET("avx2")
+    size_t stuff_avx2(const uint8_t* in, size_t n, uint8_t* out) {
+        const __m256i start = _mm256_set1_epi8(static_cast<char>(START_FLAG));
+        const __m256i esc = _mm256_set1_epi8(static_cast<char>(ESC));
+        const __m256i end = _mm256_set1_epi8(static_cast<char>(END_FLAG));
+
+        size_t i = 0, w = 0;
+        while (i + 32 <= n) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+            __m256i hit = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, start), _mm256_cmpeq_epi8(v, esc)), _mm256_cmpeq_epi8(v, end));
+            unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(hit));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + w), v);
+            if (mask == 0) {
+                i += 32;
+                w += 32;
+                continue;
+            }
+            unsigned k = static_cast<unsigned>(std::countr_zero(mask));
+            w += k;
+            out[w++] = ESC;
+            out[w++] = in[i + k] ^ 0x20;
+            i += k + 1;
+        }
+        return stuff_tail(in, n, i, out, w);
+    }
+
+    OKS_TARGET("avx2")
+    bool unstuff_avx2(const uint8_t* in, size_t n, uint8_t* out, size_t& written) {
+        const __m256i esc = _mm256_set1_epi8(static_cast<char>(ESC));
+        const __m256i end = _mm256_set1_epi8(static_cast<char>(END_FLAG));
+
+        size_t i = 0, w = 0;
+        while (i + 32 <= n) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+            __m256i hit = _mm256_or_si256(_mm256_cmpeq_epi8(v, esc), _mm256_cmpeq_epi8(v, end));
+            unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(hit));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + w), v);
+            if (mask == 0) {
+                i += 32;
+                w += 32;
+                continue;
+            }
+            unsigned k = static_cast<unsigned>(std::countr_zero(mask));
+            w += k;
+            i += k;
+            if (in[i] == END_FLAG) {
+                written = w;
+                return true;
+            }
+            if (i + 1 >= n) {
+                written = w;
+                return false;
+            }
+            out[w++] = in[i + 1] ^ 0x20;
+            i += 2;
+        }
+        return unstuff_tail(in, n, i, out, w, written);
+    }
+#endif
+
+    struct Kernels {
+        StuffFn stuff;
+        UnstuffFn unstuff;
+    };
+
+    Kernels select_kernels() {
+#if OKS_ARCH_X86
+        if (CpuFeatures::has_avx2()) return { stuff_avx2, unstuff_avx2 };
+        if (CpuFeatures::has_sse2()) return { stuff_sse2, unstuff_sse2 };
+#endif
+        return { stuff_scalar, unstuff_scalar };
+    }
+
+    const Kernels& kernels() {
+        static const Kernels k = select_kernels();
+        return k;
+    }
+}
+
+namespace ByteStuffing {
+    size_t stuff(std::span<const uint8_t> in, uint8_t* out) {
+        return kernels().stuff(in.data(), in.size(), out);
+    }
+
+    bool unstuff(std::span<const uint8_t> in, uint8_t* out, size_t& written) {
+        return kernels().unstuff(in.data(), in.size(), out, written);
+    }
+}
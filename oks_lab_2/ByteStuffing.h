@@ -0,0 +1,23 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <span>
+
+// - .   SSE2/AVX2    ,
+//      .
+namespace ByteStuffing {
+    const uint8_t START_FLAG = 0x08;
+    const uint8_t ESC = 0x1B;
+    const uint8_t END_FLAG = 0x7E;
+
+    //    stuff  n  
+    constexpr size_t max_stuffed_size(size_t n) { return n * 2; }
+
+    //  START_FLAG, ESC  END_FLAG. out   max_stuffed_size(in.size()) .
+    //    .
+    size_t stuff(std::span<const uint8_t> in, uint8_t* out);
+
+    //     END_FLAG    . out   in.size() .
+    //  false,     ESC.
+    bool unstuff(std::span<const uint8_t> in, uint8_t* out, size_t& written);
+}
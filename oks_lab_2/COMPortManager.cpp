@@ -1,96 +1,67 @@
 ﻿#include "COMPortManager.h"
-#include <iostream>
+#include "ByteStuffing.h"
+#include "ChannelNoise.h"
+#include "HammingBlock.h"
+#include "LineReceiver.h"
+#include "Log.h"
+#include "Lz.h"
 #include <chrono>
 #include <algorithm>
 #include <random>
 #include <cmath>
 #include <iomanip>
 
-static const uint8_t FRAME_START_FLAG = 0x08;
-static const uint8_t FRAME_END_FLAG = 0x7E;
-
 COMPortManager::COMPortManager() :
-    hSendPort(INVALID_HANDLE_VALUE),
-    hReceivePort(INVALID_HANDLE_VALUE),
     currentSendPort(""),
     currentReceivePort(""),
     currentBaudRate(9600),
     stopReceiverThread(false),
-    receiverStateInFrame(false) {
+    lastSeenUncorrectable(0),
+    fecMode(FecMode::Whole),
+    crcEnabled(false),
+    compressionEnabled(false),
+    compactHeader(false),
+    arqMode(ARQ::Mode::Off),
+    arqWindow(ARQ::DEFAULT_WINDOW),
+    txSeq(1) {
+    backoff = BackoffStrategy::create(csmaParams);
+    ackParser.setHandler([this](Frame& parsed) {
+        ARQ::Ack ack;
+        if (parsed.correct_in_place() != HammingStatus::DoubleDetected &&
+            ARQ::decode_ack_frame(parsed, ack)) {
+            arqSender.onAck(ack);
+        }
+    });
 }
 
 COMPortManager::~COMPortManager() {
     closePorts();
 }
 
-uint8_t COMPortManager::extractPortNumber(const std::string& portName) {
-    uint8_t num = 0;
-    for (char c : portName) {
-        if (std::isdigit(static_cast<unsigned char>(c))) {
-            num = static_cast<uint8_t>(num * 10 + (c - '0'));
-        }
-    }
-    return num;
-}
-
-bool COMPortManager::openPort(const std::string& portName, HANDLE& hPort) {
-    std::string fullPortName = "\\\\.\\" + portName;
-    hPort = CreateFileA(fullPortName.c_str(),
-        GENERIC_READ | GENERIC_WRITE,
-        0, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
-
-    if (hPort == INVALID_HANDLE_VALUE) return false;
-
-    DCB dcbSerialParams = { 0 };
-    dcbSerialParams.DCBlength = sizeof(dcbSerialParams);
-    if (!GetCommState(hPort, &dcbSerialParams)) {
-        CloseHandle(hPort);
-        return false;
-    }
-    dcbSerialParams.BaudRate = currentBaudRate;
-    dcbSerialParams.ByteSize = 8;
-    dcbSerialParams.StopBits = ONESTOPBIT;
-    dcbSerialParams.Parity = NOPARITY;
-    if (!SetCommState(hPort, &dcbSerialParams)) {
-        CloseHandle(hPort);
-        return false;
-    }
-
-    COMMTIMEOUTS timeouts = { 0 };
-    timeouts.ReadIntervalTimeout = MAXDWORD;
-    timeouts.ReadTotalTimeoutConstant = 10;
-    timeouts.ReadTotalTimeoutMultiplier = 0;
-    timeouts.WriteTotalTimeoutConstant = 10;
-    timeouts.WriteTotalTimeoutMultiplier = 0;
-    SetCommTimeouts(hPort, &timeouts);
-
-    return true;
-}
-
-void COMPortManager::reconfigurePort(HANDLE hPort) {
-    DCB dcbSerialParams = { 0 };
-    dcbSerialParams.DCBlength = sizeof(dcbSerialParams);
-    if (GetCommState(hPort, &dcbSerialParams)) {
-        dcbSerialParams.BaudRate = currentBaudRate;
-        SetCommState(hPort, &dcbSerialParams);
-    }
+std::unique_ptr<Transport> COMPortManager::openPort(const std::string& portName) {
+    std::unique_ptr<Transport> port = Transport::create(portName);
+    if (!port->open(portName, currentBaudRate)) return nullptr;
+    return port;
 }
 
 bool COMPortManager::setSendPort(const std::string& portName) {
-    if (hSendPort != INVALID_HANDLE_VALUE) CloseHandle(hSendPort);
-    if (openPort(portName, hSendPort)) {
+    sendPort.reset();
+    sendPort = openPort(portName);
+    if (sendPort) {
         currentSendPort = portName;
+        traceChannel = Transport::portNumber(portName);
+        txHeaders.reset();
         return true;
     }
     return false;
 }
 
 bool COMPortManager::setReceivePort(const std::string& portName) {
-    stopReceiverThread = true;
-    if (receiverThread.joinable()) receiverThread.join();
-    if (hReceivePort != INVALID_HANDLE_VALUE) CloseHandle(hReceivePort);
+    stopReceiver();
+    receivePort.reset();
 
-    if (openPort(portName, hReceivePort)) {
+    receivePort = openPort(portName);
+    if (receivePort) {
         currentReceivePort = portName;
         stopReceiverThread = false;
         receiverThread = std::thread(&COMPortManager::receiverThreadFunc, this);
@@ -99,308 +70,573 @@ bool COMPortManager::setReceivePort(const std::string& portName) {
     return false;
 }
 
-bool COMPortManager::setBaudRate(DWORD baudRate) {
+bool COMPortManager::setBaudRate(uint32_t baudRate) {
     currentBaudRate = baudRate;
-    if (hSendPort != INVALID_HANDLE_VALUE) reconfigurePort(hSendPort);
-    if (hReceivePort != INVALID_HANDLE_VALUE) reconfigurePort(hReceivePort);
-    return true;
+    bool ok = true;
+    if (sendPort) ok = sendPort->setBaudRate(baudRate) && ok;
+    if (receivePort) ok = receivePort->setBaudRate(baudRate) && ok;
+    return ok;
+}
+
+void COMPortManager::setArqMode(ARQ::Mode mode, int window) {
+    arqWindow = std::clamp(window, 1, ARQ::max_window(mode));
+    arqMode = mode;
+}
+
+void COMPortManager::setCsmaParams(const CSMA::Params& params) {
+    // Поток приема работает с копией параметров: перезапускаем его
+    bool restart = receiverThread.joinable();
+    stopReceiver();
+
+    csmaParams = params;
+    backoff = BackoffStrategy::create(csmaParams);
+
+    if (restart && receivePort) {
+        stopReceiverThread = false;
+        receiverThread = std::thread(&COMPortManager::receiverThreadFunc, this);
+    }
+}
+
+void COMPortManager::setFixedPayload(size_t size) {
+    payloadSizer.setFixed(size);
+}
+
+void COMPortManager::setAdaptivePayload(size_t minSize, size_t maxSize) {
+    payloadSizer.setAdaptive(minSize, maxSize);
+}
+
+void COMPortManager::setFecMode(FecMode mode) {
+    fecMode = mode;
+}
+
+void COMPortManager::setCrcEnabled(bool enabled) {
+    crcEnabled = enabled;
+}
+
+void COMPortManager::setCompressionEnabled(bool enabled) {
+    compressionEnabled = enabled;
+}
+
+void COMPortManager::setCompactHeader(bool enabled) {
+    compactHeader = enabled;
 }
 
 const std::string& COMPortManager::getCurrentSendPort() const { return currentSendPort; }
 const std::string& COMPortManager::getCurrentReceivePort() const { return currentReceivePort; }
-DWORD COMPortManager::getCurrentBaudRate() const { return currentBaudRate; }
+uint32_t COMPortManager::getCurrentBaudRate() const { return currentBaudRate; }
+ARQ::Mode COMPortManager::getArqMode() const { return arqMode; }
+int COMPortManager::getArqWindow() const { return arqWindow; }
+const PayloadSizer& COMPortManager::getPayloadSizer() const { return payloadSizer; }
+FecMode COMPortManager::getFecMode() const { return fecMode; }
+bool COMPortManager::getCrcEnabled() const { return crcEnabled; }
+bool COMPortManager::getCompressionEnabled() const { return compressionEnabled; }
+bool COMPortManager::getCompactHeader() const { return compactHeader; }
+const CSMA::Params& COMPortManager::getCsmaParams() const { return csmaParams; }
 const std::vector<uint8_t>& COMPortManager::getLastSentRawFrame() const { return lastSentRawFrame; }
 
-CSMA::Stats COMPortManager::getGlobalStats() const { return globalStats; }
-CSMA::Stats COMPortManager::getLastSessionStats() const { return lastSessionStats; }
-void COMPortManager::resetGlobalStats() { globalStats = CSMA::Stats(); }
+CSMA::StatsSnapshot COMPortManager::currentSnapshot() const {
+    return stats.snapshot();
+}
 
-void COMPortManager::closePorts() {
+CSMA::StatsSnapshot COMPortManager::getGlobalSnapshot() const {
+    CSMA::StatsSnapshot snap = currentSnapshot();
+    std::lock_guard<std::mutex> lock(statsMutex);
+    snap -= globalBase;
+    return snap;
+}
+
+CSMA::StatsSnapshot COMPortManager::getLastSessionSnapshot() const {
+    CSMA::StatsSnapshot snap = currentSnapshot();
+    std::lock_guard<std::mutex> lock(statsMutex);
+    snap -= sessionBase;
+    return snap;
+}
+
+CSMA::Stats COMPortManager::getGlobalStats() const {
+    return getGlobalSnapshot().totals;
+}
+
+CSMA::Stats COMPortManager::getLastSessionStats() const {
+    return getLastSessionSnapshot().totals;
+}
+
+void COMPortManager::resetGlobalStats() {
+    CSMA::StatsSnapshot now = currentSnapshot();
+    std::lock_guard<std::mutex> lock(statsMutex);
+    globalBase = now;
+}
+
+// Поток приема спит в receiveUntil без срока: будим его через interrupt()
+void COMPortManager::stopReceiver() {
     stopReceiverThread = true;
+    if (receivePort) receivePort->interrupt();
     if (receiverThread.joinable()) receiverThread.join();
+}
 
-    if (hSendPort != INVALID_HANDLE_VALUE) { CloseHandle(hSendPort); hSendPort = INVALID_HANDLE_VALUE; }
-    if (hReceivePort != INVALID_HANDLE_VALUE) { CloseHandle(hReceivePort); hReceivePort = INVALID_HANDLE_VALUE; }
+void COMPortManager::closePorts() {
+    stopReceiver();
+
+    sendPort.reset();
+    receivePort.reset();
 }
 
-bool COMPortManager::writeByte(HANDLE hPort, uint8_t byte) {
-    DWORD bw = 0;
-    return WriteFile(hPort, &byte, 1, &bw, NULL) && bw == 1;
+bool COMPortManager::portsReady() const {
+    return sendPort && receivePort;
 }
 
-bool COMPortManager::readByte(HANDLE hPort, uint8_t& byte) {
-    DWORD br = 0;
-    if (ReadFile(hPort, &byte, 1, &br, NULL) && br == 1) return true;
-    return false;
+bool COMPortManager::writeByte(Transport& port, uint8_t byte) {
+    return port.write(std::span<const uint8_t>(&byte, 1)) == 1;
 }
 
-void COMPortManager::sendJamSignal() {
-    for (int i = 0; i < CSMA::JAM_LENGTH; ++i) {
-        writeByte(hSendPort, CSMA::JAM);
+// Разбирает обратный канал порта отправки. Байты внутри кадра уходят
+// в разборщик подтверждений ARQ, остальные считаются управляющими.
+COMPortManager::LineSignals COMPortManager::pollSendPort(Timing::Clock::time_point deadline) {
+    LineSignals signals;
+    uint8_t buffer[64];
+    size_t got = sendPort->readUntil(buffer, deadline);
+    signals.bytes = got;
+
+    for (size_t i = 0; i < got; ++i) {
+        uint8_t b = buffer[i];
+        if (ackParser.collectingFields() || b == ByteStuffing::START_FLAG || b == ByteStuffing::END_FLAG) {
+            ackParser.push(b);
+        }
+        else if (b == CSMA::ACK) {
+            signals.ack = true;
+        }
+        else if (b == CSMA::COL) {
+            signals.collision = true;
+        }
     }
-    std::lock_guard<std::mutex> lock(outputMutex);
-    std::cout << "Отправка JAM-сигнала..." << std::endl;
+    return signals;
 }
 
-// --- ФУНКЦИЯ ИСКАЖЕНИЯ (Восстановлена) ---
-void COMPortManager::distort_payload(std::vector<uint8_t>& payload) {
-    if (payload.empty()) {
-        return;
+// Отбрасывает устаревшие управляющие байты, не теряя подтверждений ARQ
+void COMPortManager::drainSendPort() {
+    while (pollSendPort(Timing::Clock::now()).bytes > 0) {
     }
+}
 
-    static thread_local std::mt19937 rng(std::random_device{}());
-
-    std::uniform_real_distribution<double> prob_dist(0.0, 1.0);
-    double p = prob_dist(rng);
+void COMPortManager::sendJamSignal() {
+    for (int i = 0; i < csmaParams.jamLength; ++i) {
+        writeByte(*sendPort, CSMA::JAM);
+    }
+    LOG_INFO("Отправка JAM-сигнала...");
+}
 
-    // Вероятность: 85% - 1 бит, 15% - 2 бита (как было у вас)
-    int bits_to_flip = (p < 0.85) ? 1 : 2;
+// Передает кадр порциями в темпе линии (8N1: 10 бит на байт).
+// Пока порция уходит в линию, порт слушается на COL, и передача
+// прерывается сразу после коллизии. Срок каждой порции отсчитывается
+// от начала кадра, поэтому погрешность пробуждений не накапливается.
+bool COMPortManager::transmitFrame(std::span<const uint8_t> raw) {
+    using namespace std::chrono;
+    using Timing::Clock;
 
-    size_t total_bits = payload.size() * 8;
-    std::uniform_int_distribution<size_t> bit_pos_dist(0, total_bits - 1);
+    const double bytesPerSecond = currentBaudRate / 10.0;
+    const size_t chunkSize = std::max<size_t>(1, static_cast<size_t>(bytesPerSecond * csmaParams.txChunkMs / 1000.0));
 
-    size_t pos1 = bit_pos_dist(rng);
+    auto start = Clock::now();
+    size_t sent = 0;
 
-    // Искажение первого бита
-    payload[pos1 / 8] ^= (1 << (pos1 % 8));
+    while (sent < raw.size()) {
+        size_t written = sendPort->write(raw.subspan(sent, std::min(chunkSize, raw.size() - sent)));
+        if (written == 0) break;
+        sent += written;
 
-    if (bits_to_flip == 2) {
-        size_t pos2;
+        auto deadline = start + duration_cast<Clock::duration>(duration<double>(sent / bytesPerSecond));
         do {
-            pos2 = bit_pos_dist(rng);
-        } while (pos1 == pos2);
-
-        // Искажение второго бита
-        payload[pos2 / 8] ^= (1 << (pos2 % 8));
+            if (pollSendPort(deadline).collision) {
+                return true;
+            }
+        } while (Clock::now() < deadline);
     }
+    return false;
+}
+
+// --- ФУНКЦИЯ ИСКАЖЕНИЯ (Восстановлена) ---
+void COMPortManager::distort_payload(std::span<uint8_t> payload) {
+    static thread_local std::mt19937 rng(std::random_device{}());
+
+    // Вероятность: 85% - 1 бит, 15% - 2 бита (как было у вас)
+    ChannelNoise::Model::lab().apply(payload, rng);
 }
 
-bool COMPortManager::sendMessage(const std::string& message, DWORD* bytesWrittenPtr) {
-    if (hSendPort == INVALID_HANDLE_VALUE) return false;
+bool COMPortManager::sendMessage(const std::string& message, size_t* bytesWrittenPtr) {
+    if (!sendPort) return false;
 
-    lastSessionStats = CSMA::Stats();
+    {
+        CSMA::StatsSnapshot now = currentSnapshot();
+        std::lock_guard<std::mutex> lock(statsMutex);
+        sessionBase = now;
+    }
+    lastSeenUncorrectable = stats.count(CSMA::StatsRecorder::Counter::Uncorrectable);
+
+    // Несжимаемое сообщение уходит как есть, без флага
+    txCompressed = compressionEnabled && Lz::compress(
+        std::span<const uint8_t>(reinterpret_cast<const uint8_t*>(message.data()), message.size()), txPacked);
+    const std::string& payload = txCompressed ? txPacked : message;
+    if (txCompressed) {
+        LOG_INFO("Сообщение сжато: ", message.size(), " -> ", payload.size(), " байт");
+    }
 
-    const size_t maxDataPerFrame = 32;
     size_t totalWritten = 0;
-    uint8_t seq = 1;
+    bool ok = (arqMode == ARQ::Mode::Off) ? sendUnreliable(payload, totalWritten) : sendReliable(payload, totalWritten);
+    // Кадр, который не ушел, мог открыть новую опорную запись сжатых
+    // заголовков: следующее сообщение начинается с опорного кадра
+    if (!ok) txHeaders.reset();
 
-    for (size_t offset = 0; offset < message.size(); offset += maxDataPerFrame) {
-        size_t len = std::min<size_t>(maxDataPerFrame, message.size() - offset);
-        Frame frame;
-        fill_frame(frame, seq, message, offset, len);
-        std::vector<uint8_t> raw = frame.create_frame();
-        lastSentRawFrame = raw;
+    if (ok && bytesWrittenPtr) *bytesWrittenPtr = totalWritten;
+    return ok;
+}
 
-        int attempts = 0;
-        bool frameSent = false;
+// Захватывает канал (CSMA/CD) и передает один кадр.
+// false — превышено число попыток.
+bool COMPortManager::sendFrameCsma(std::span<const uint8_t> raw, int& collisions) {
+    using Counter = CSMA::StatsRecorder::Counter;
+    using Histogram = CSMA::StatsRecorder::Histogram;
 
-        while (attempts < CSMA::MAX_ATTEMPTS) {
-            lastSessionStats.total_attempts++;
-            globalStats.total_attempts++;
+    int attempts = 0;
+    bool frameSent = false;
+    auto frameReady = Timing::Clock::now();
 
-            // 1. Прослушивание
-            {
-                std::lock_guard<std::mutex> lock(outputMutex);
-                std::cout << "Прослушивание канала..." << std::endl;
-            }
+    const std::chrono::milliseconds slotTime(csmaParams.slotTimeMs);
 
-            PurgeComm(hSendPort, PURGE_RXCLEAR);
-            writeByte(hSendPort, CSMA::ENQ);
+    while (attempts < csmaParams.maxAttempts) {
+        stats.add(Counter::TotalAttempts);
 
-            uint8_t response = 0;
-            bool channelFree = false;
+        // 1. Прослушивание
+        LOG_INFO("Прослушивание канала...");
 
-            auto startWait = std::chrono::steady_clock::now();
-            while (std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startWait).count() < CSMA::SLOT_TIME_MS) {
-                if (readByte(hSendPort, response)) {
-                    if (response == CSMA::ACK) {
-                        channelFree = true;
-                        break;
-                    }
-                }
+        drainSendPort();
+        writeByte(*sendPort, CSMA::ENQ);
+        Trace::emit(Trace::Event::EnqSent, traceChannel, attempts + 1);
+
+        // Ответ ждем ровно слот: поток спит в poll до ACK или конца слота
+        bool channelFree = false;
+        auto slotEnd = Timing::Clock::now() + slotTime;
+        while (Timing::Clock::now() < slotEnd) {
+            if (pollSendPort(slotEnd).ack) {
+                Trace::emit(Trace::Event::AckReceived, traceChannel);
+                channelFree = true;
+                break;
             }
+        }
 
-            if (!channelFree) {
-                lastSessionStats.busy_events++;
-                globalStats.busy_events++;
+        if (!channelFree) {
+            stats.add(Counter::BusyEvents);
+            Trace::emit(Trace::Event::ChannelBusy, traceChannel);
 
-                std::lock_guard<std::mutex> lock(outputMutex);
-                std::cout << "Канал занят. Ожидание..." << std::endl;
-                Sleep(CSMA::SLOT_TIME_MS);
-                continue;
-            }
-            else {
-                std::lock_guard<std::mutex> lock(outputMutex);
-                std::cout << "Канал свободен. Передача данных..." << std::endl;
-            }
+            LOG_INFO("Канал занят. Ожидание...");
+            auto retryAt = slotEnd + backoff->busyDelaySlots() * slotTime;
+            Trace::emit(Trace::Event::BackoffBegin, traceChannel, Trace::micros(retryAt - Timing::Clock::now()));
+            Timing::sleep_until(retryAt);
+            Trace::emit(Trace::Event::BackoffEnd, traceChannel);
+            continue;
+        }
+        else if (!backoff->shouldTransmit()) {
+            // p-настойчивый доступ: свободный слот пропущен
+            LOG_INFO("Канал свободен, передача отложена на слот.");
+            Trace::emit(Trace::Event::BackoffBegin, traceChannel, Trace::micros(slotTime));
+            Timing::sleep_for(slotTime);
+            Trace::emit(Trace::Event::BackoffEnd, traceChannel);
+            continue;
+        }
+        else {
+            LOG_INFO("Канал свободен. Передача данных...");
+        }
 
-            // 2. Передача
-            bool collisionDetected = false;
-            for (uint8_t b : raw) {
-                writeByte(hSendPort, b);
-
-                uint8_t signal = 0;
-                Sleep(2);
-                if (readByte(hSendPort, signal)) {
-                    if (signal == CSMA::COL) {
-                        collisionDetected = true;
-                        break;
-                    }
-                }
-            }
+        // 2. Передача
+        auto txBegin = Timing::Clock::now();
+        Trace::emit(Trace::Event::TxBegin, traceChannel, static_cast<uint32_t>(raw.size()));
+        bool collisionDetected = transmitFrame(raw);
+        Trace::emit(Trace::Event::TxEnd, traceChannel);
 
-            if (collisionDetected) {
-                lastSessionStats.collisions++;
-                globalStats.collisions++;
+        if (collisionDetected) {
+            stats.add(Counter::Collisions);
+            Trace::emit(Trace::Event::Collision, traceChannel);
 
-                attempts++;
-                sendJamSignal();
+            attempts++;
+            sendJamSignal();
 
-                lastSessionStats.jam_sent++;
-                globalStats.jam_sent++;
+            stats.add(Counter::JamSent);
+            Trace::emit(Trace::Event::JamSent, traceChannel);
 
-                {
-                    std::lock_guard<std::mutex> lock(outputMutex);
-                    std::cout << "Обнаружена коллизия! Попытка: " << attempts << std::endl;
-                }
+            LOG_INFO("Обнаружена коллизия! Попытка: ", attempts);
 
-                if (attempts >= CSMA::MAX_ATTEMPTS) break;
+            if (attempts >= csmaParams.maxAttempts) break;
 
-                int k = std::min<int>(attempts, CSMA::MAX_BACKOFF_LIMIT);
-                int max_r = (1 << k);
-                int r = rand() % (max_r + 1);
-                int delay = r * CSMA::SLOT_TIME_MS;
+            auto delay = backoff->collisionDelaySlots(attempts) * slotTime;
+            stats.recordDuration(Histogram::BackoffDelay, delay);
 
-                {
-                    std::lock_guard<std::mutex> lock(outputMutex);
-                    std::cout << "Задержка: " << delay << " мс" << std::endl;
-                }
-                Sleep(delay);
+            LOG_INFO("Задержка: ", delay.count(), " мс");
+            Trace::emit(Trace::Event::BackoffBegin, traceChannel, Trace::micros(delay));
+            Timing::sleep_for(delay);
+            Trace::emit(Trace::Event::BackoffEnd, traceChannel);
+        }
+        else {
+            frameSent = true;
+            auto txEnd = Timing::Clock::now();
+            stats.add(Counter::PacketsSent);
+            stats.recordDuration(Histogram::AccessDelay, txBegin - frameReady);
+            stats.recordDuration(Histogram::FrameLatency, txEnd - frameReady);
+
+            LOG_INFO("Кадр передан успешно.");
+            break;
+        }
+    }
+
+    // Передачи кадра: прерванные коллизией и удачная
+    stats.record(Histogram::Attempts, frameSent ? attempts + 1 : attempts);
+    collisions = attempts;
+
+    if (!frameSent) {
+        LOG_ERROR("Ошибка: превышено число попыток отправки.");
+    }
+    return frameSent;
+}
+
+// Сообщает итог кадра адаптивному выбору размера: коллизии за время
+// передачи кадра и неисправимые ошибки, замеченные приемником с прошлого кадра
+void COMPortManager::updatePayloadSize(size_t wireBytes, int collisions, int lost) {
+    uint64_t uncorrectable = stats.count(CSMA::StatsRecorder::Counter::Uncorrectable);
+    payloadSizer.onFrameResult(wireBytes, collisions, static_cast<int>(uncorrectable - lastSeenUncorrectable) + lost);
+    lastSeenUncorrectable = uncorrectable;
+}
+
+bool COMPortManager::sendUnreliable(const std::string& message, size_t& totalWritten) {
+    uint8_t seq = 1;
+
+    // Буфер кадра выделяется один раз и переиспользуется для всех кадров
+    txFrameBuffer.resize(Frame::max_encoded_size(std::min(payloadSizer.getMax(), message.size())));
+    Frame frame;
+
+    for (size_t offset = 0; offset < message.size(); ) {
+        size_t len = payloadSizer.next(message.size() - offset);
+        fill_frame(frame, seq, message, offset, len);
+        size_t rawSize = frame.encode_into(txFrameBuffer, &txHeaders);
+        std::span<const uint8_t> raw(txFrameBuffer.data(), rawSize);
+        lastSentRawFrame.assign(raw.begin(), raw.end());
+
+        int collisions = 0;
+        if (!sendFrameCsma(raw, collisions)) return false;
+        updatePayloadSize(rawSize, collisions, 0);
+
+        totalWritten += rawSize;
+        offset += len;
+    }
+    return true;
+}
+
+// Передача со скользящим окном. Сессию открывает SYNC (кадр без данных),
+// дальше в линии одновременно находится до arqWindow неподтвержденных кадров.
+bool COMPortManager::sendReliable(const std::string& message, size_t& totalWritten) {
+    using namespace std::chrono;
+
+    const size_t maxDataPerFrame = std::min(payloadSizer.getMax(), message.size());
+
+    // Тайм-аут покрывает передачу самого длинного кадра данных и обратного кадра подтверждения
+    const double bytesPerSecond = currentBaudRate / 10.0;
+    const size_t roundTripBytes = Frame::max_encoded_size(maxDataPerFrame) + Frame::max_encoded_size(ARQ::ACK_PAYLOAD_SIZE);
+    auto timeout = milliseconds(ARQ::RETRANSMIT_TIMEOUT_MS) +
+        duration_cast<steady_clock::duration>(duration<double>(roundTripBytes / bytesPerSecond));
+
+    arqSender.reset(arqMode, arqWindow, txSeq, timeout);
+
+    Frame frame;
+    size_t offset = 0;
+    bool syncPending = true;
+    bool ok = true;
+
+    while (ok && (syncPending || offset < message.size() || !arqSender.allAcked())) {
+        // 1. Новые кадры, пока окно открыто
+        while (ok && arqSender.canSend() && (syncPending || offset < message.size())) {
+            size_t len = syncPending ? 0 : payloadSizer.next(message.size() - offset);
+            uint8_t seq = arqSender.nextSeq();
+            fill_frame(frame, seq, message, offset, len);
+            if (syncPending) frame.timestamp = arqSender.openSession(frame.timestamp);
+
+            std::vector<uint8_t>& raw = arqTxFrames[frame.seqNumber];
+            raw.resize(Frame::max_encoded_size(len));
+            raw.resize(frame.encode_into(raw, &txHeaders));
+            if (len > 0) lastSentRawFrame = raw;
+
+            int collisions = 0;
+            ok = sendFrameCsma(raw, collisions);
+            if (ok) {
+                updatePayloadSize(raw.size(), collisions, 0);
+                arqSender.onSent(steady_clock::now());
+                totalWritten += raw.size();
+                offset += len;
+                syncPending = false;
             }
-            else {
-                frameSent = true;
-                lastSessionStats.packets_sent++;
-                globalStats.packets_sent++;
-
-                {
-                    std::lock_guard<std::mutex> lock(outputMutex);
-                    std::cout << "Кадр передан успешно." << std::endl;
-                }
+        }
+
+        // 2. Ждем подтверждений до открытия окна или ближайшего тайм-аута
+        while (ok && !arqSender.allAcked()) {
+            auto now = steady_clock::now();
+            auto deadline = arqSender.nextDeadline();
+            if (now >= deadline) break;
+            if (arqSender.canSend() && offset < message.size()) break;
+
+            pollSendPort(deadline);
+        }
+
+        // 3. Повторы кадров с истекшим таймером
+        arqSender.dueRetransmissions(steady_clock::now(), arqDueRetransmissions);
+        for (uint8_t seq : arqDueRetransmissions) {
+            if (!ok) break;
+            if (!arqSender.isPending(seq)) continue; // подтвержден во время предыдущих повторов
+
+            if (!arqSender.retriesLeft(seq)) {
+                LOG_ERROR("Ошибка: кадр ", int(seq), " не подтвержден.");
+                ok = false;
                 break;
             }
-        }
 
-        if (!frameSent) {
-            std::lock_guard<std::mutex> lock(outputMutex);
-            std::cout << "Ошибка: превышено число попыток отправки." << std::endl;
-            return false;
+            LOG_WARNING("Тайм-аут подтверждения. Повтор кадра ", int(seq));
+            stats.add(CSMA::StatsRecorder::Counter::Retransmissions);
+
+            int collisions = 0;
+            ok = sendFrameCsma(arqTxFrames[seq], collisions);
+            if (ok) {
+                updatePayloadSize(arqTxFrames[seq].size(), collisions, 1); // тайм-аут — кадр потерян
+                arqSender.onRetransmitted(seq, steady_clock::now());
+                totalWritten += arqTxFrames[seq].size();
+            }
         }
-        totalWritten += raw.size();
+        if (ok && !arqDueRetransmissions.empty()) arqSender.onGoBackSent(steady_clock::now());
     }
 
-    if (bytesWrittenPtr) *bytesWrittenPtr = static_cast<DWORD>(totalWritten);
-    return true;
+    txSeq = arqSender.nextSeq();
+    return ok;
 }
 
 void COMPortManager::fill_frame(Frame& frame, uint8_t& seq, const std::string& message, size_t offset, size_t len) {
-    frame.sender = extractPortNumber(currentSendPort);
-    frame.receiver = extractPortNumber(currentReceivePort);
+    frame.sender = Transport::portNumber(currentSendPort);
+    frame.receiver = Transport::portNumber(currentReceivePort);
     auto now = std::chrono::duration_cast<std::chrono::milliseconds>(
         std::chrono::system_clock::now().time_since_epoch()
     ).count();
     frame.timestamp = static_cast<uint64_t>(now);
+    Trace::emit(Trace::Event::FrameEnqueued, traceChannel, seq);
     frame.seqNumber = seq++;
     frame.dataLen = static_cast<uint16_t>(len);
+    frame.setFecMode(fecMode);
+    frame.setCrc(crcEnabled);
+    frame.setCompressed(txCompressed);
+    frame.setCompactHeader(compactHeader);
     frame.data.assign(message.begin() + offset, message.begin() + offset + len);
 }
 
 void COMPortManager::receiverThreadFunc() {
-    std::mt19937 rng(std::random_device{}());
-    std::uniform_real_distribution<double> dist(0.0, 1.0);
-
-    receiverBuffer.clear();
-    receiverStateInFrame = false;
-    bool jamSequenceActive = false;
-
-    while (!stopReceiverThread) {
-        if (hReceivePort == INVALID_HANDLE_VALUE) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(100));
-            continue;
+    // Поток работает с копией параметров, см. setCsmaParams
+    LineReceiver line(csmaParams, std::random_device{}());
+
+    // Подтверждения ARQ уходят обратно через порт приема
+    Frame ackFrame;
+    std::vector<uint8_t> ackBuffer(Frame::max_encoded_size(ARQ::ACK_PAYLOAD_SIZE));
+    auto sendAck = [&]() {
+        if (!arqReceiver.inSession()) return;
+        ARQ::Ack ack = arqReceiver.ack();
+        uint8_t payload[ARQ::ACK_PAYLOAD_SIZE];
+        ARQ::encode_ack_payload(ack, payload);
+
+        ackFrame.sender = Transport::portNumber(currentReceivePort);
+        ackFrame.receiver = Transport::portNumber(currentSendPort);
+        ackFrame.timestamp = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count());
+        ackFrame.seqNumber = ack.cumulative;
+        ackFrame.dataLen = static_cast<uint16_t>(ARQ::ACK_PAYLOAD_SIZE);
+        ackFrame.data.assign(std::span<const uint8_t>(payload));
+
+        size_t rawSize = ackFrame.encode_into(ackBuffer);
+        receivePort->write(std::span<const uint8_t>(ackBuffer.data(), rawSize));
+    };
+
+    // false — кольцо приема полно, кадр остался у вызывающего
+    auto enqueue = [this](Frame& frame) {
+        return receivedFrameQueue.push(std::move(frame));
+    };
+
+    // Исход проверки FEC для статистики
+    auto countFrame = [this](HammingStatus status) {
+        using Counter = CSMA::StatsRecorder::Counter;
+        stats.add(Counter::FramesReceived);
+        Trace::emit(Trace::Event::EccResult, traceChannel, static_cast<uint32_t>(status));
+        switch (status) {
+        case HammingStatus::Clean: stats.add(Counter::EccClean); break;
+        case HammingStatus::SingleCorrected: stats.add(Counter::EccCorrected); break;
+        case HammingStatus::DoubleDetected: stats.add(Counter::Uncorrectable); break;
+        }
+        return status;
+    };
+
+    arqReceiver.reset(ARQ::Mode::Off, 1, 0);
+    line.setFrameHandler([&](Frame& parsed) {
+        // ПРИМЕНЯЕМ ИСКАЖЕНИЕ ПЕРЕД СОХРАНЕНИЕМ
+        distort_payload(parsed.data);
+
+        ARQ::Mode mode = arqMode;
+        if (mode == ARQ::Mode::Off) {
+            countFrame(parsed.check());
+            // Без ARQ повторов не будет: кадр, не влезший в кольцо, потерян
+            if (!enqueue(parsed)) stats.add(CSMA::StatsRecorder::Counter::QueueOverflows);
+            return;
         }
 
-        uint8_t byte;
-        if (readByte(hReceivePort, byte)) {
-
-            if (byte == CSMA::ENQ) {
-                double roll = dist(rng);
-                if (roll < CSMA::PROB_CHANNEL_BUSY) {
-                    std::lock_guard<std::mutex> lock(outputMutex);
-                    std::cout << "Канал занят (ENQ)." << std::endl; // Убрано слово "Среда"
-                }
-                else {
-                    writeByte(hReceivePort, CSMA::ACK);
-                }
-                jamSequenceActive = false;
-                continue;
-            }
-
-            if (byte == CSMA::JAM) {
-                if (!jamSequenceActive) {
-                    std::lock_guard<std::mutex> lock(outputMutex);
-                    std::cout << "Получен JAM-сигнал." << std::endl;
-                    jamSequenceActive = true;
-                }
-                receiverBuffer.clear();
-                receiverStateInFrame = false;
-                continue;
-            }
-
-            jamSequenceActive = false;
-
-            double collisionRoll = dist(rng);
-            if (collisionRoll < CSMA::PROB_COLLISION) {
-                std::lock_guard<std::mutex> lock(outputMutex);
-                std::cout << "Коллизия!" << std::endl; // Убрано слово "Среда"
-
-                writeByte(hReceivePort, CSMA::COL);
-                receiverBuffer.clear();
-                receiverStateInFrame = false;
-                continue;
-            }
-
-            if (byte == FRAME_START_FLAG) {
-                receiverBuffer.clear();
-                receiverStateInFrame = true;
-                receiverBuffer.push_back(byte);
-                continue;
-            }
+        // В режиме ARQ кадр исправляется сразу: неисправимый не подтверждается
+        if (parsed.dataLen == 0) {
+            arqReceiver.sync(parsed.seqNumber, parsed.timestamp, mode, arqWindow, enqueue);
+            sendAck();
+            return;
+        }
 
-            if (receiverStateInFrame) {
-                receiverBuffer.push_back(byte);
-                if (byte == FRAME_END_FLAG) {
-                    Frame parsed;
-                    if (Frame::de_byte_stuffing(receiverBuffer, parsed)) {
-
-                        // ПРИМЕНЯЕМ ИСКАЖЕНИЕ ПЕРЕД СОХРАНЕНИЕМ
-                        distort_payload(parsed.data);
-
-                        std::lock_guard<std::mutex> qLock(queueMutex);
-                        receivedFrameQueue.push(parsed);
-                    }
-                    receiverBuffer.clear();
-                    receiverStateInFrame = false;
-                }
-            }
+        if (countFrame(parsed.correct_in_place()) == HammingStatus::DoubleDetected) {
+            LOG_WARNING("Кадр ", int(parsed.seqNumber), " отброшен: двойная ошибка.");
+        }
+        else {
+            arqReceiver.accept(std::move(parsed), enqueue);
         }
+        sendAck();
+    });
+    line.setReply([this](uint8_t byte) {
+        writeByte(*receivePort, byte);
+    });
+    line.setEventHandler([this](LineReceiver::Event event) {
+        switch (event) {
+        case LineReceiver::Event::ChannelBusy: Trace::emit(Trace::Event::ChannelBusy, traceChannel); break;
+        case LineReceiver::Event::Jam: Trace::emit(Trace::Event::JamReceived, traceChannel); break;
+        case LineReceiver::Event::Collision: Trace::emit(Trace::Event::Collision, traceChannel); break;
+        }
+        switch (event) {
+        case LineReceiver::Event::ChannelBusy: LOG_INFO("Канал занят (ENQ)."); break; // Убрано слово "Среда"
+        case LineReceiver::Event::Jam: LOG_INFO("Получен JAM-сигнал."); break;
+        case LineReceiver::Event::Collision: LOG_INFO("Коллизия!"); break; // Убрано слово "Среда"
+        }
+    });
+    auto handleBytes = [&line](std::span<const uint8_t> bytes) {
+        line.feed(bytes);
+    };
+
+    // Забираем все, что накопилось в порту, одним вызовом.
+    // Без данных поток спит в ядре до прихода байтов или stopReceiver()
+    while (!stopReceiverThread) {
+        receivePort->receiveUntil(handleBytes, Timing::NO_DEADLINE);
     }
 }
 
 std::vector<Frame> COMPortManager::receiveAllFrames() {
     std::vector<Frame> frames;
-    std::lock_guard<std::mutex> lock(queueMutex);
-    while (!receivedFrameQueue.empty()) {
-        frames.push_back(receivedFrameQueue.front());
-        receivedFrameQueue.pop();
-    }
+    drainFrames(frames);
     return frames;
+}
+
+size_t COMPortManager::drainFrames(std::vector<Frame>& out) {
+    return receivedFrameQueue.drain([&out](Frame&& frame) {
+        out.push_back(std::move(frame));
+    });
+}
+
+bool COMPortManager::waitForFrames(int timeoutMs) {
+    return receivedFrameQueue.waitFor(std::chrono::milliseconds(timeoutMs));
 }
\ No newline at end of file
@@ -1,50 +1,97 @@
 #pragma once
-#include <windows.h>
 #include <string>
 #include <vector>
 #include <mutex>
 #include <atomic>
 #include <thread>
-#include <queue>
+#include <span>
+#include <memory>
+#include <array>
+#include "Arq.h"
+#include "Backoff.h"
 #include "Frame.h"
+#include "FrameParser.h"
+#include "PayloadSizer.h"
+#include "SpscQueue.h"
 #include "CsmaConfig.h"
+#include "StatsRecorder.h"
+#include "Trace.h"
+#include "Transport.h"
 
 class COMPortManager {
 private:
-    HANDLE hSendPort;
-    HANDLE hReceivePort;
+    std::unique_ptr<Transport> sendPort;
+    std::unique_ptr<Transport> receivePort;
     std::string currentSendPort;
     std::string currentReceivePort;
-    DWORD currentBaudRate;
+    uint16_t traceChannel = 0;  //    
+    uint32_t currentBaudRate;
 
     std::vector<uint8_t> lastSentRawFrame;
+    std::vector<uint8_t> txFrameBuffer;
+    std::string txPacked;       //  ,  
+    bool txCompressed = false;  //     FLAG_COMPRESSED
+    CompactHeader::Encoder txHeaders;
 
     std::atomic<bool> stopReceiverThread;
     std::thread receiverThread;
 
-    mutable std::mutex outputMutex;
-    std::mutex queueMutex;
-
-    std::queue<Frame> receivedFrameQueue;
-
-    CSMA::Stats globalStats;
-    CSMA::Stats lastSessionStats;
-
-    //  
-    std::vector<uint8_t> receiverBuffer;
-    bool receiverStateInFrame;
-
-    bool openPort(const std::string& portName, HANDLE& hPort);
-    void reconfigurePort(HANDLE hPort);
-    static uint8_t extractPortNumber(const std::string& portName);
+    //  :   ,  
+    static const size_t RX_QUEUE_CAPACITY = 1024;
+    SpscQueue<Frame, RX_QUEUE_CAPACITY> receivedFrameQueue;
+
+    CSMA::Params csmaParams;
+    std::unique_ptr<BackoffStrategy> backoff;
+
+    //      ;    
+    //      
+    CSMA::StatsRecorder stats;
+    mutable std::mutex statsMutex;
+    CSMA::StatsSnapshot globalBase;
+    CSMA::StatsSnapshot sessionBase;
+
+    PayloadSizer payloadSizer;
+    uint64_t lastSeenUncorrectable;
+    std::atomic<FecMode> fecMode;                       //  FCS  
+    std::atomic<bool> crcEnabled;                       // CRC-32C   
+    std::atomic<bool> compressionEnabled;               //      
+    std::atomic<bool> compactHeader;                    //    
+
+    // ---   (ARQ) ---
+    std::atomic<ARQ::Mode> arqMode;
+    std::atomic<int> arqWindow;
+    uint8_t txSeq;                                      //    
+    ARQ::Sender arqSender;
+    ARQ::Receiver arqReceiver;
+    std::array<std::vector<uint8_t>, 256> arqTxFrames;  //     
+    std::vector<uint8_t> arqDueRetransmissions;
+    FrameParser ackParser;                              //     
+
+    struct LineSignals {
+        bool ack = false;
+        bool collision = false;
+        size_t bytes = 0;
+    };
+
+    std::unique_ptr<Transport> openPort(const std::string& portName);
 
     void receiverThreadFunc();
-    bool writeByte(HANDLE hPort, uint8_t byte);
-    bool readByte(HANDLE hPort, uint8_t& byte);
+    void stopReceiver();
+    bool writeByte(Transport& port, uint8_t byte);
     void sendJamSignal();
+    bool transmitFrame(std::span<const uint8_t> raw);
+    //      deadline    
+    LineSignals pollSendPort(Timing::Clock::time_point deadline);
+    void drainSendPort();
+    // collisions      
+    bool sendFrameCsma(std::span<const uint8_t> raw, int& collisions);
+    bool sendUnreliable(const std::string& message, size_t& totalWritten);
+    bool sendReliable(const std::string& message, size_t& totalWritten);
+    void updatePayloadSize(size_t wireBytes, int collisions, int lost);
+    CSMA::StatsSnapshot currentSnapshot() const;
 
     // ---     ---
-    void distort_payload(std::vector<uint8_t>& payload);
+    void distort_payload(std::span<uint8_t> payload);
 
 public:
     COMPortManager();
@@ -52,21 +99,45 @@ public:
 
     bool setSendPort(const std::string& portName);
     bool setReceivePort(const std::string& portName);
-    bool setBaudRate(DWORD baudRate);
-
-    bool sendMessage(const std::string& message, DWORD* bytesWrittenPtr = nullptr);
+    bool setBaudRate(uint32_t baudRate);
+    void setArqMode(ARQ::Mode mode, int window);
+    void setCsmaParams(const CSMA::Params& params);
+    void setFixedPayload(size_t size);
+    void setAdaptivePayload(size_t minSize, size_t maxSize);
+    void setFecMode(FecMode mode);
+    void setCrcEnabled(bool enabled);
+    void setCompressionEnabled(bool enabled);
+    void setCompactHeader(bool enabled);
+
+    bool sendMessage(const std::string& message, size_t* bytesWrittenPtr = nullptr);
     void fill_frame(Frame& frame, uint8_t& seq, const std::string& message, size_t offset, size_t len);
 
     std::vector<Frame> receiveAllFrames();
+    //      out,   
+    size_t drainFrames(std::vector<Frame>& out);
+    //      timeoutMs,  
+    bool waitForFrames(int timeoutMs);
 
     void closePorts();
+    bool portsReady() const;
 
     const std::string& getCurrentSendPort() const;
     const std::string& getCurrentReceivePort() const;
-    DWORD getCurrentBaudRate() const;
+    uint32_t getCurrentBaudRate() const;
+    ARQ::Mode getArqMode() const;
+    int getArqWindow() const;
+    const PayloadSizer& getPayloadSizer() const;
+    FecMode getFecMode() const;
+    bool getCrcEnabled() const;
+    bool getCompressionEnabled() const;
+    bool getCompactHeader() const;
+    const CSMA::Params& getCsmaParams() const;
     const std::vector<uint8_t>& getLastSentRawFrame() const;
 
     CSMA::Stats getGlobalStats() const;
     CSMA::Stats getLastSessionStats() const;
+    //     ,    FEC
+    CSMA::StatsSnapshot getGlobalSnapshot() const;
+    CSMA::StatsSnapshot getLastSessionSnapshot() const;
     void resetGlobalStats();
 };
\ No newline at end of file
@@ -0,0 +1,111 @@
+﻿#include "ChannelNoise.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <sstream>
+
+namespace ChannelNoise {
+
+    namespace {
+        void flip(std::span<uint8_t> buffer, size_t bit) {
+            buffer[bit / 8] ^= static_cast<uint8_t>(1 << (bit % 8));
+        }
+
+        const int MAX_DISTINCT_BITS = 64;
+
+        // Инвертирует count (не больше MAX_DISTINCT_BITS) различных битов
+        size_t flip_distinct(std::span<uint8_t> buffer, int count, std::mt19937& rng) {
+            size_t total_bits = buffer.size() * 8;
+            count = static_cast<int>(std::min<size_t>({ static_cast<size_t>(count), total_bits, static_cast<size_t>(MAX_DISTINCT_BITS) }));
+
+            std::uniform_int_distribution<size_t> bit_pos_dist(0, total_bits - 1);
+            size_t chosen[MAX_DISTINCT_BITS];
+            int n = 0;
+            while (n < count) {
+                size_t pos = bit_pos_dist(rng);
+                if (std::find(chosen, chosen + n, pos) != chosen + n) continue;
+                chosen[n++] = pos;
+                flip(buffer, pos);
+            }
+            return static_cast<size_t>(n);
+        }
+    }
+
+    bool Model::parse(const std::string& text, Model& out) {
+        std::string kind = text.substr(0, text.find(':'));
+        std::string arg = text.find(':') == std::string::npos ? "" : text.substr(text.find(':') + 1);
+
+        if (kind == "none") { out = none(); return true; }
+        if (kind == "lab") { out = lab(); return true; }
+        if (arg.empty()) return false;
+        if (kind == "bits") { out = fixedBits(std::max(1, std::atoi(arg.c_str()))); return true; }
+        if (kind == "ber") {
+            // Вероятность ошибки бита; при 1 инвертировался бы каждый бит
+            double p = std::atof(arg.c_str());
+            if (!(p >= 0.0 && p < 1.0)) return false;
+            out = bernoulli(p);
+            return true;
+        }
+        if (kind == "burst") { out = burst(std::max(1, std::atoi(arg.c_str()))); return true; }
+        return false;
+    }
+
+    std::string Model::name() const {
+        std::ostringstream oss;
+        switch (kind) {
+        case Kind::None: oss << "none"; break;
+        case Kind::Lab: oss << "lab"; break;
+        case Kind::FixedBits: oss << "bits:" << bits; break;
+        case Kind::Bernoulli: oss << "ber:" << ber; break;
+        case Kind::Burst: oss << "burst:" << burstLength; break;
+        }
+        return oss.str();
+    }
+
+    size_t Model::apply(std::span<uint8_t> buffer, std::mt19937& rng) const {
+        if (buffer.empty()) {
+            return 0;
+        }
+        size_t total_bits = buffer.size() * 8;
+
+        switch (kind) {
+        case Kind::None:
+            return 0;
+
+        case Kind::Lab: {
+            std::uniform_real_distribution<double> prob_dist(0.0, 1.0);
+            int bits_to_flip = (prob_dist(rng) < 0.85) ? 1 : 2;
+            return flip_distinct(buffer, bits_to_flip, rng);
+        }
+
+        case Kind::FixedBits:
+            return flip_distinct(buffer, bits, rng);
+
+        case Kind::Bernoulli: {
+            if (ber <= 0.0) return 0;
+            // geometric_distribution требует p < 1
+            if (ber >= 1.0) {
+                for (uint8_t& b : buffer) b = static_cast<uint8_t>(~b);
+                return total_bits;
+            }
+            // Пропуски между ошибками распределены геометрически: не разыгрываем каждый бит
+            std::geometric_distribution<size_t> gap(ber);
+            size_t flipped = 0;
+            for (size_t pos = gap(rng); pos < total_bits; pos += 1 + gap(rng)) {
+                flip(buffer, pos);
+                flipped++;
+            }
+            return flipped;
+        }
+
+        case Kind::Burst: {
+            size_t length = std::min<size_t>(burstLength, total_bits);
+            std::uniform_int_distribution<size_t> start_dist(0, total_bits - length);
+            size_t start = start_dist(rng);
+            for (size_t i = 0; i < length; ++i) flip(buffer, start + i);
+            return length;
+        }
+        }
+        return 0;
+    }
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <random>
+#include <span>
+#include <string>
+
+//     
+namespace ChannelNoise {
+    enum class Kind {
+        None,
+        Lab,        // 85%  1 , 15%  2  (  )
+        FixedBits,  //  bits   (  64)
+        Bernoulli,  //      ber
+        Burst       //      burstLength
+    };
+
+    struct Model {
+        Kind kind = Kind::Lab;
+        int bits = 1;
+        double ber = 0.0;
+        int burstLength = 4;
+
+        static Model none() { return Model{ Kind::None }; }
+        static Model lab() { return Model{ Kind::Lab }; }
+        static Model fixedBits(int n) { Model m{ Kind::FixedBits }; m.bits = n; return m; }
+        static Model bernoulli(double p) { Model m{ Kind::Bernoulli }; m.ber = p; return m; }
+        static Model burst(int length) { Model m{ Kind::Burst }; m.burstLength = length; return m; }
+
+        //   "none", "lab", "bits:K", "ber:P" (0 <= P < 1), "burst:L"
+        static bool parse(const std::string& text, Model& out);
+
+        std::string name() const;
+
+        //  buffer,    
+        size_t apply(std::span<uint8_t> buffer, std::mt19937& rng) const;
+    };
+}
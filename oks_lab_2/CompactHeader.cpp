@@ -0,0 +1,120 @@
+﻿#include "CompactHeader.h"
+#include "Frame.h"
+
+namespace {
+    size_t put_varint(uint8_t* out, uint64_t v) {
+        size_t n = 0;
+        while (v >= 0x80) {
+            out[n++] = static_cast<uint8_t>((v & 0x7F) | 0x80);
+            v >>= 7;
+        }
+        out[n++] = static_cast<uint8_t>(v);
+        return n;
+    }
+
+    CompactHeader::Result get_varint(const uint8_t* in, size_t n, size_t& pos, uint64_t& value, int maxBits) {
+        value = 0;
+        for (int shift = 0; shift < maxBits; shift += 7) {
+            if (pos >= n) return CompactHeader::Result::Incomplete;
+            uint8_t b = in[pos++];
+            value |= static_cast<uint64_t>(b & 0x7F) << shift;
+            if (!(b & 0x80)) {
+                // Лишние старшие биты — не наш формат
+                if (maxBits < 64 && (value >> maxBits) != 0) return CompactHeader::Result::Error;
+                return CompactHeader::Result::Ok;
+            }
+        }
+        return CompactHeader::Result::Error;
+    }
+
+    size_t write_tail(const Frame& frame, uint8_t* out) {
+        size_t n = 0;
+        out[n++] = frame.seqNumber;
+        n += put_varint(out + n, frame.dataLen);
+        return n;
+    }
+}
+
+namespace CompactHeader {
+
+    size_t write_reference(const Frame& frame, uint8_t context, uint8_t* out) {
+        size_t n = 0;
+        out[n++] = static_cast<uint8_t>(REFERENCE | (context & CONTEXT_MASK));
+        out[n++] = frame.sender;
+        out[n++] = frame.receiver;
+        n += put_varint(out + n, frame.timestamp);
+        return n + write_tail(frame, out + n);
+    }
+
+    size_t Encoder::write(const Frame& frame, uint8_t* out) {
+        bool reference = !valid || frame.sender != sender || frame.receiver != receiver ||
+            frame.timestamp < timestamp || sinceReference >= REFRESH_FRAMES;
+        if (reference) {
+            valid = true;
+            context = nextContext;
+            nextContext = static_cast<uint8_t>((nextContext + 1) & CONTEXT_MASK);
+            sender = frame.sender;
+            receiver = frame.receiver;
+            timestamp = frame.timestamp;
+            sinceReference = 0;
+            return write_reference(frame, context, out);
+        }
+
+        ++sinceReference;
+        size_t n = 0;
+        out[n++] = context;
+        n += put_varint(out + n, frame.timestamp - timestamp);
+        return n + write_tail(frame, out + n);
+    }
+
+    Result Decoder::read(const uint8_t* in, size_t n, Frame& frame, size_t& used) {
+        if (n == 0) return Result::Incomplete;
+        uint8_t ctrl = in[0];
+        bool reference = (ctrl & REFERENCE) != 0;
+        uint8_t context = ctrl & CONTEXT_MASK;
+        Entry& entry = entries[context % CONTEXTS];
+
+        size_t pos = 1;
+        uint8_t sender = entry.sender;
+        uint8_t receiver = entry.receiver;
+        if (reference) {
+            if (n < 3) return Result::Incomplete;
+            sender = in[1];
+            receiver = in[2];
+            pos = 3;
+        }
+        else if (!entry.valid || entry.context != context) {
+            return Result::Error;
+        }
+
+        uint64_t time = 0;
+        Result r = get_varint(in, n, pos, time, 64);
+        if (r != Result::Ok) return r;
+        if (pos >= n) return Result::Incomplete;
+        uint8_t seq = in[pos++];
+        uint64_t len = 0;
+        r = get_varint(in, n, pos, len, 16);
+        if (r != Result::Ok) return r;
+
+        frame.sender = sender;
+        frame.receiver = receiver;
+        frame.timestamp = reference ? time : entry.timestamp + time;
+        frame.seqNumber = seq;
+        frame.dataLen = static_cast<uint16_t>(len);
+        if (reference) {
+            entry.valid = true;
+            entry.context = context;
+            entry.sender = sender;
+            entry.receiver = receiver;
+            entry.timestamp = time;
+        }
+        used = pos;
+        return Result::Ok;
+    }
+
+    void Decoder::reset() {
+        for (Entry& entry : entries) {
+            entry = Entry();
+        }
+    }
+}
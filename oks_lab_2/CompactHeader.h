@@ -0,0 +1,75 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+
+struct Frame;
+
+//    (Frame::FLAG_COMPACT)  13  .
+//    : REFERENCE     (0-127).
+//   :   ctrl, , ,  (varint), ,  (varint)
+//   : ctrl,     (varint), ,  (varint)
+//             .
+//    ,     :  
+//   (ARQ)     .  
+//  16  ,      ;
+//    ,       
+//    ,     .
+namespace CompactHeader {
+    const uint8_t REFERENCE = 0x80;
+    const uint8_t CONTEXT_MASK = 0x7F;
+    const size_t CONTEXTS = 16;             //   ,     
+    //     ,    
+    const size_t REFRESH_FRAMES = 16;
+    // ctrl +  +  (varint  10 ) +  +  (varint  3 )
+    const size_t MAX_SIZE = 17;
+
+    enum class Result {
+        Incomplete,     //     
+        Ok,
+        Error           //       
+    };
+
+    //  ,      .  
+    size_t write_reference(const Frame& frame, uint8_t context, uint8_t* out);
+
+    //   : ,    
+    class Encoder {
+    public:
+        explicit Encoder(uint8_t firstContext = 0) : nextContext(firstContext & CONTEXT_MASK) {}
+
+        //     out (  MAX_SIZE ),  
+        size_t write(const Frame& frame, uint8_t* out);
+
+        //    
+        void reset() { valid = false; }
+
+    private:
+        bool valid = false;
+        uint8_t nextContext;
+        uint8_t context = 0;
+        uint8_t sender = 0;
+        uint8_t receiver = 0;
+        uint64_t timestamp = 0;
+        size_t sinceReference = 0;
+    };
+
+    //   
+    class Decoder {
+    public:
+        //     in   frame; used   .
+        //       
+        Result read(const uint8_t* in, size_t n, Frame& frame, size_t& used);
+
+        void reset();
+
+    private:
+        struct Entry {
+            bool valid = false;
+            uint8_t context = 0;
+            uint8_t sender = 0;
+            uint8_t receiver = 0;
+            uint64_t timestamp = 0;
+        };
+        Entry entries[CONTEXTS];
+    };
+}
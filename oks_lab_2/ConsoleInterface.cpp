@@ -1,21 +1,26 @@
 ﻿#include "ConsoleInterface.h"
 #include "HammingBlock.h"
 #include <iostream>
+#include <cstdio>
 #include <sstream>
 #include <iomanip>
-#include <conio.h>
-#include <windows.h>
+#include <limits>
 #include <algorithm>
+#include "ConsolePlatform.h"
+#include "Log.h"
+#include "Lz.h"
+#include "Trace.h"
 
 static int inputInteger(int min, int max) {
     int number = 0;
     while (true) {
-        if (scanf_s("%d", &number) == 1) {
-            int c = getchar();
+        if (std::cin >> number) {
+            int c = std::cin.get();
             if (c == '\n' && number >= min && number <= max) break;
         }
-        printf("Неправильный ввод. Попробуйте ещё раз: ");
-        rewind(stdin);
+        std::cout << "Неправильный ввод. Попробуйте ещё раз: ";
+        std::cin.clear();
+        std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
     }
     return number;
 }
@@ -26,16 +31,67 @@ static std::string to_hex(uint8_t v) {
     return oss.str();
 }
 
-ConsoleInterface::ConsoleInterface()
-    : availablePortPairs{ {"COM3","COM4"},{"COM10","COM11"} },
+static const char* arqModeName(ARQ::Mode mode) {
+    switch (mode) {
+    case ARQ::Mode::GoBackN: return "Go-Back-N";
+    case ARQ::Mode::SelectiveRepeat: return "Selective Repeat";
+    default: return "выключена";
+    }
+}
+
+static const char* fecModeName(FecMode mode) {
+    switch (mode) {
+    case FecMode::Blocked: return "(72,64) на каждые 8 байт";
+    case FecMode::Interleaved: return "(72,64) с чередованием битов";
+    default: return "один код на кадр";
+    }
+}
+
+// Собирает сообщение из данных кадров. Подряд идущие сжатые кадры образуют
+// поток блоков Lz, он распаковывается целиком. false — поток поврежден или оборван
+static bool assemble_message(const std::vector<Frame>& frames, std::string& out) {
+    bool ok = true;
+    std::vector<uint8_t> packed;
+    auto unpack = [&]() {
+        size_t pos = 0;
+        while (pos < packed.size()) {
+            size_t used = Lz::decompress(std::span<const uint8_t>(packed).subspan(pos), out);
+            if (used == 0) {
+                ok = false;
+                break;
+            }
+            pos += used;
+        }
+        packed.clear();
+    };
+
+    for (const auto& f : frames) {
+        if (f.isCompressed()) {
+            packed.insert(packed.end(), f.data.begin(), f.data.end());
+            continue;
+        }
+        unpack();
+        out.append(reinterpret_cast<const char*>(f.data.data()), f.data.size());
+    }
+    unpack();
+    return ok;
+}
+
+ConsoleInterface::ConsoleInterface(const CSMA::Params& csmaParams)
+#ifdef _WIN32
+    : availablePortPairs{ {"COM3","COM4"},{"COM10","COM11"},{"LOOP1A","LOOP1B"} },
+#else
+    : availablePortPairs{ {"/dev/ttyUSB0","/dev/ttyUSB1"},{"/dev/ttyS0","/dev/ttyS1"},{"PTY1A","PTY1B"},{"LOOP1A","LOOP1B"} },
+#endif
     baudRates{ 50,75,110,134,150,200,300,600,1200,2400,4800,9600,19200,38400,57600,115200 } {
+    portManager.setCsmaParams(csmaParams);
 }
 
 void ConsoleInterface::run() {
     while (true) {
-        system("cls");
+        ConsolePlatform::clearScreen();
         showMainMenu();
-        int choice = inputInteger(1, 7); // Изменено на 7
+        int choice = inputInteger(1, 12);
         switch (choice) {
         case 1: setupPorts(); break;
         case 2: sendMessageMenu(); break;
@@ -43,7 +99,12 @@ void ConsoleInterface::run() {
         case 4: changeBaudRate(); break;
         case 5: viewLastSentFrame(); break;
         case 6: viewStatistics(); break; // НОВЫЙ ПУНКТ
-        case 7:
+        case 7: arqSettings(); break;
+        case 8: payloadSettings(); break;
+        case 9: traceSettings(); break;
+        case 10: fecSettings(); break;
+        case 11: compressionSettings(); break;
+        case 12:
             portManager.closePorts();
             return;
         default:
@@ -56,7 +117,22 @@ void ConsoleInterface::showMainMenu() {
     std::cout << "Текущие настройки:" << std::endl;
     std::cout << "Порт отправки: " << (portManager.getCurrentSendPort().empty() ? "не выбран" : portManager.getCurrentSendPort()) << std::endl;
     std::cout << "Порт приема: " << (portManager.getCurrentReceivePort().empty() ? "не выбран" : portManager.getCurrentReceivePort()) << std::endl;
-    std::cout << "Скорость: " << portManager.getCurrentBaudRate() << " бод" << std::endl << std::endl;
+    std::cout << "Скорость: " << portManager.getCurrentBaudRate() << " бод" << std::endl;
+    std::cout << "Надежная доставка: " << arqModeName(portManager.getArqMode());
+    if (portManager.getArqMode() != ARQ::Mode::Off) std::cout << ", окно " << portManager.getArqWindow();
+    std::cout << std::endl;
+    const PayloadSizer& sizer = portManager.getPayloadSizer();
+    const CSMA::Params& csma = portManager.getCsmaParams();
+    std::cout << "Доступ к каналу: " << CSMA::backoff_name(csma.backoff) << ", слот " << csma.slotTimeMs << " мс" << std::endl;
+    std::cout << "Данные кадра: ";
+    if (sizer.getMode() == PayloadSizer::Mode::Fixed) std::cout << sizer.getCurrent() << " байт";
+    else std::cout << "адаптивно " << sizer.getMin() << "-" << sizer.getMax() << " байт, сейчас " << sizer.getCurrent();
+    std::cout << std::endl;
+    std::cout << "Помехоустойчивый код: " << fecModeName(portManager.getFecMode());
+    if (portManager.getCrcEnabled()) std::cout << " + CRC-32C";
+    std::cout << std::endl;
+    std::cout << "Сжатие данных: " << (portManager.getCompressionEnabled() ? "включено" : "выключено")
+              << ", заголовок: " << (portManager.getCompactHeader() ? "сжатый" : "полный") << std::endl << std::endl;
     std::cout << "Меню:" << std::endl;
     std::cout << "1. Настроить порты" << std::endl;
     std::cout << "2. Отправить сообщение" << std::endl;
@@ -64,20 +140,36 @@ void ConsoleInterface::showMainMenu() {
     std::cout << "4. Изменить скорость передачи" << std::endl;
     std::cout << "5. Просмотр структуры последнего переданного кадра" << std::endl;
     std::cout << "6. Статистика передачи" << std::endl; // НОВЫЙ ПУНКТ
-    std::cout << "7. Выход" << std::endl;
+    std::cout << "7. Надежная доставка (ARQ)" << std::endl;
+    std::cout << "8. Размер данных кадра" << std::endl;
+    std::cout << "9. Трассировка протокола" << std::endl;
+    std::cout << "10. Помехоустойчивый код" << std::endl;
+    std::cout << "11. Сжатие данных и заголовка" << std::endl;
+    std::cout << "12. Выход" << std::endl;
     std::cout << "Выберите действие: ";
 }
 
 void ConsoleInterface::setupPorts() {
-    system("cls");
+    ConsolePlatform::clearScreen();
     std::cout << "=== Настройка портов ===" << std::endl;
     std::cout << "Выберите пару портов:" << std::endl;
     for (size_t i = 0; i < availablePortPairs.size(); ++i) {
         std::cout << i + 1 << ". Отправка: " << availablePortPairs[i].sendPort << " / Прием: " << availablePortPairs[i].receivePort << std::endl;
     }
-    std::cout << "Ваш выбор (1-" << availablePortPairs.size() << "): ";
-    int choice = inputInteger(1, static_cast<int>(availablePortPairs.size()));
-    auto selectedPair = availablePortPairs[choice - 1];
+    std::cout << availablePortPairs.size() + 1 << ". Ввести имена портов вручную" << std::endl;
+    std::cout << "Ваш выбор (1-" << availablePortPairs.size() + 1 << "): ";
+    int choice = inputInteger(1, static_cast<int>(availablePortPairs.size()) + 1);
+
+    PortPair selectedPair;
+    if (choice <= static_cast<int>(availablePortPairs.size())) {
+        selectedPair = availablePortPairs[choice - 1];
+    }
+    else {
+        std::cout << "Порт отправки: ";
+        std::getline(std::cin >> std::ws, selectedPair.sendPort);
+        std::cout << "Порт приема: ";
+        std::getline(std::cin >> std::ws, selectedPair.receivePort);
+    }
 
     bool isPortsOpen = true;
     std::cout << "\nНастройка портов..." << std::endl;
@@ -97,17 +189,17 @@ void ConsoleInterface::setupPorts() {
     }
     if (isPortsOpen) std::cout << "\nНастройка завершена успешно. Нажмите любую клавишу для продолжения..." << std::endl;
     else std::cout << "\nНастройка завершена с ошибками. Проверьте состояние портов и повторите попытку.\nНажмите любую клавишу для продолжения..." << std::endl;
-    _getch();
+    ConsolePlatform::waitKey();
     rewind(stdin);
 }
 
 void ConsoleInterface::sendMessageMenu() {
-    system("cls");
+    ConsolePlatform::clearScreen();
 
-    if ((portManager.getCurrentSendPort() != "COM3" && portManager.getCurrentSendPort() != "COM10") || (portManager.getCurrentReceivePort() != "COM4" && portManager.getCurrentReceivePort() != "COM11")) {
+    if (!portManager.portsReady()) {
         std::cout << "Ошибка: Порты не настроены!" << std::endl;
         std::cout << "\nНажмите любую клавишу для продолжения..." << std::endl;
-        _getch();
+        ConsolePlatform::waitKey();
         return;
     }
 
@@ -118,17 +210,20 @@ void ConsoleInterface::sendMessageMenu() {
     std::cout << "\nВведите сообщение для отправки: ";
     std::string message;
     std::getline(std::cin >> std::ws, message);
-    if (message.empty()) { std::cout << "Сообщение не может быть пустым!" << std::endl; _getch(); rewind(stdin); return; }
+    if (message.empty()) { std::cout << "Сообщение не может быть пустым!" << std::endl; ConsolePlatform::waitKey(); rewind(stdin); return; }
 
-    DWORD bytesWritten = 0;
-    if (portManager.sendMessage(message, &bytesWritten)) {
+    size_t bytesWritten = 0;
+    bool sent = portManager.sendMessage(message, &bytesWritten);
+    // Журнал передачи выводится фоновым потоком: дожидаемся его перед итогом
+    Log::flush();
+    if (sent) {
         std::cout << "Сообщение успешно отправлено!" << std::endl;
     }
     else {
         std::cout << "Ошибка отправки сообщения!" << std::endl;
     }
     std::cout << "\nНажмите любую клавишу для продолжения..." << std::endl;
-    _getch(); rewind(stdin);
+    ConsolePlatform::waitKey(); rewind(stdin);
 }
 
 std::string ConsoleInterface::prettyPrintRawFrame(const std::vector<uint8_t>& stuffed) const {
@@ -138,35 +233,88 @@ std::string ConsoleInterface::prettyPrintRawFrame(const std::vector<uint8_t>& st
     if (stuffed.size() < 2) return "Некорректный кадр.";
 
     size_t i = 0;
+    uint8_t flags = 0;
     oss << "Флаг начала кадра: " << to_hex(stuffed[i++]) << "\n";
 
-    if (stuffed[i] == ESC) i++;
-    oss << "Отправитель: " << to_hex(stuffed[i++]) << "\n";
+    if (i + 2 < stuffed.size() && stuffed[i] == ESC && stuffed[i + 1] == Frame::FORMAT_MARK) {
+        oss << "Метка расширенного формата: " << to_hex(stuffed[i]) << " " << to_hex(stuffed[i + 1]) << "\n";
+        i += 2;
+        // Флаг сжатых данных совпадает с START_FLAG и приходит экранированным
+        flags = stuffed[i] == ESC ? stuffed[++i] ^ 0x20 : stuffed[i];
+        i++;
+        oss << "Флаги: " << to_hex(flags) << " (FEC: "
+            << HammingBlock::mode_name(static_cast<FecMode>(flags & Frame::FLAG_FEC_MASK));
+        if (flags & Frame::FLAG_CRC32C) oss << ", CRC-32C";
+        if (flags & Frame::FLAG_COMPRESSED) oss << ", сжатые данные";
+        if (flags & Frame::FLAG_COMPACT) oss << ", сжатый заголовок";
+        oss << ")\n";
+    }
 
-    if (stuffed[i] == ESC) i++;
-    oss << "Получатель: " << to_hex(stuffed[i++]) << "\n";
+    uint16_t dataLen = 0;
+    if (flags & Frame::FLAG_COMPACT) {
+        // Поля сжатого заголовка читаются уже без экранирования
+        auto next = [&]() -> uint8_t {
+            if (i >= stuffed.size() - 1) return 0;
+            if (stuffed[i] == ESC && i + 1 < stuffed.size() - 1) {
+                i += 2;
+                return stuffed[i - 1] ^ 0x20;
+            }
+            return stuffed[i++];
+        };
+        auto varint = [&]() {
+            uint64_t value = 0;
+            for (int shift = 0; shift < 64; shift += 7) {
+                uint8_t b = next();
+                value |= uint64_t(b & 0x7F) << shift;
+                if (!(b & 0x80)) break;
+            }
+            return value;
+        };
 
-    uint64_t time = 0;
-    for (int idx = 0; idx < 8; idx++) {
-        if (stuffed[i] == ESC) i++;
-        time |= (uint64_t(stuffed[i++]) << (8 * idx));
+        uint8_t ctrl = next();
+        bool reference = (ctrl & CompactHeader::REFERENCE) != 0;
+        oss << "Управляющий байт: " << to_hex(ctrl) << " (" << (reference ? "опорный" : "зависимый")
+            << ", запись " << int(ctrl & CompactHeader::CONTEXT_MASK) << ")\n";
+        if (reference) {
+            oss << "Отправитель: " << to_hex(next()) << "\n";
+            oss << "Получатель: " << to_hex(next()) << "\n";
+            oss << "Время отправления: " << varint() << " мс\n";
+        }
+        else {
+            oss << "Время отправления: +" << varint() << " мс от опорного кадра\n";
+        }
+        oss << "Порядковый номер кадра: " << to_hex(next()) << "\n";
+        dataLen = static_cast<uint16_t>(varint());
+        oss << "Длина данных: " << dataLen << "\n";
     }
+    else {
+        if (stuffed[i] == ESC) i++;
+        oss << "Отправитель: " << to_hex(stuffed[i++]) << "\n";
 
-    oss << "Время отправления: ";
-    for (int b = 0; b < 8; b++) {
-        uint8_t byte = (time >> (8 * b)) & 0xFF;
-        oss << to_hex(byte) << " ";
-    }
-    oss << "\n";
+        if (stuffed[i] == ESC) i++;
+        oss << "Получатель: " << to_hex(stuffed[i++]) << "\n";
 
-    if (stuffed[i] == ESC) i++;
-    oss << "Порядковый номер кадра: " << to_hex(stuffed[i++]) << "\n";
+        uint64_t time = 0;
+        for (int idx = 0; idx < 8; idx++) {
+            if (stuffed[i] == ESC) i++;
+            time |= (uint64_t(stuffed[i++]) << (8 * idx));
+        }
 
-    uint16_t dataLen = 0;
-    if (stuffed[i] == ESC) i++;
-    dataLen |= (uint16_t)stuffed[i++] << 8;
-    if (stuffed[i] == ESC) i++;
-    dataLen |= (uint16_t)stuffed[i++];
+        oss << "Время отправления: ";
+        for (int b = 0; b < 8; b++) {
+            uint8_t byte = (time >> (8 * b)) & 0xFF;
+            oss << to_hex(byte) << " ";
+        }
+        oss << "\n";
+
+        if (stuffed[i] == ESC) i++;
+        oss << "Порядковый номер кадра: " << to_hex(stuffed[i++]) << "\n";
+
+        if (stuffed[i] == ESC) i++;
+        dataLen |= (uint16_t)stuffed[i++] << 8;
+        if (stuffed[i] == ESC) i++;
+        dataLen |= (uint16_t)stuffed[i++];
+    }
 
     oss << "Данные: ";
     int logical_bytes_read = 0;
@@ -183,6 +331,14 @@ std::string ConsoleInterface::prettyPrintRawFrame(const std::vector<uint8_t>& st
     oss << "\n";
 
     oss << "FCS: ";
+    if (flags & Frame::FLAG_CRC32C) {
+        size_t fcsLen = HammingBlock::fcs_size(dataLen, static_cast<FecMode>(flags & Frame::FLAG_FEC_MASK));
+        for (size_t n = 0; n < fcsLen && i < stuffed.size() - 1; ++n) {
+            if (stuffed[i] == ESC) oss << to_hex(stuffed[i++]) << " ";
+            oss << to_hex(stuffed[i++]) << " ";
+        }
+        oss << "\nCRC-32C: ";
+    }
     while (i < stuffed.size() - 1) {
         oss << to_hex(stuffed[i++]) << " ";
     }
@@ -193,30 +349,35 @@ std::string ConsoleInterface::prettyPrintRawFrame(const std::vector<uint8_t>& st
 }
 
 void ConsoleInterface::receiveMessageMenu() {
-    system("cls");
+    ConsolePlatform::clearScreen();
 
-    auto frames = portManager.receiveAllFrames();
+    // Кадр мог еще не дойти: ждем его без опроса очереди
+    std::vector<Frame> frames;
+    if (portManager.waitForFrames(RECEIVE_WAIT_MS)) {
+        portManager.drainFrames(frames);
+    }
 
+    Log::flush();
     if (frames.empty()) {
-        _getch();
+        ConsolePlatform::waitKey();
         return;
     }
 
-    std::string fullMessage;
-    bool had_uncorrectable_error = false;
-
+    // Исправляем все кадры на месте одним вызовом
+    std::vector<HammingFrameRef> refs;
+    refs.reserve(frames.size());
     for (auto& f : frames) {
-        HammingBlockResult res = HammingBlock::decode_and_correct(f.data, f.fcs);
-
-        if (res.double_error_detected) {
-            had_uncorrectable_error = true;
-        }
-
-        fullMessage.append(
-            reinterpret_cast<const char*>(res.corrected_data.data()),
-            res.corrected_data.size()
-        );
+        refs.push_back({ f.data, f.fcs, f.fecMode() });
     }
+    std::vector<HammingStatus> statuses(frames.size());
+    bool had_uncorrectable_error = HammingBlock::decode_batch(refs, statuses) > 0;
+    // CRC сверяется уже с исправленными данными
+    for (const auto& f : frames) {
+        if (!f.crc_matches()) had_uncorrectable_error = true;
+    }
+
+    std::string fullMessage;
+    if (!assemble_message(frames, fullMessage)) had_uncorrectable_error = true;
 
     if (had_uncorrectable_error) {
         std::cout << "Данные повреждены (обнаружена двойная или множественная ошибка)\nПринятое сообщение:\n\n";
@@ -224,11 +385,11 @@ void ConsoleInterface::receiveMessageMenu() {
 
     std::cout << fullMessage;
 
-    _getch();
+    ConsolePlatform::waitKey();
 }
 
 void ConsoleInterface::changeBaudRate() {
-    system("cls");
+    ConsolePlatform::clearScreen();
     std::cout << "=== Изменение скорости передачи ===" << std::endl;
     std::cout << "Текущая скорость: " << portManager.getCurrentBaudRate() << " бод" << std::endl << std::endl;
     std::cout << "Доступные скорости:" << std::endl;
@@ -236,35 +397,50 @@ void ConsoleInterface::changeBaudRate() {
     std::cout << "Выберите скорость (1-" << baudRates.size() << "): ";
     int choice = inputInteger(1, static_cast<int>(baudRates.size()));
     if (choice >= 1 && choice <= static_cast<int>(baudRates.size())) {
-        DWORD newBaudRate = baudRates[choice - 1];
+        uint32_t newBaudRate = baudRates[choice - 1];
         if (portManager.setBaudRate(newBaudRate)) std::cout << "Скорость изменена на " << newBaudRate << " бод" << std::endl;
         else std::cout << "Ошибка изменения скорости!" << std::endl;
     }
     else std::cout << "Неверный выбор скорости." << std::endl;
     std::cout << "\nНажмите любую клавишу для продолжения..." << std::endl;
-    _getch(); rewind(stdin);
+    ConsolePlatform::waitKey(); rewind(stdin);
 }
 
 void ConsoleInterface::viewLastSentFrame() {
-    system("cls");
+    ConsolePlatform::clearScreen();
     const auto& raw = portManager.getLastSentRawFrame();
-    if (raw.empty()) { std::cout << "Нет отправленных кадров для просмотра." << std::endl; _getch(); return; }
+    if (raw.empty()) { std::cout << "Нет отправленных кадров для просмотра." << std::endl; ConsolePlatform::waitKey(); return; }
     std::cout << prettyPrintRawFrame(raw) << std::endl;
     std::cout << "\nНажмите любую клавишу для продолжения..." << std::endl;
-    _getch(); rewind(stdin);
+    ConsolePlatform::waitKey(); rewind(stdin);
 }
 
 // НОВЫЙ МЕТОД
 void ConsoleInterface::viewStatistics() {
-    system("cls");
+    ConsolePlatform::clearScreen();
 
-    CSMA::Stats global = portManager.getGlobalStats();
-    CSMA::Stats last = portManager.getLastSessionStats();
+    CSMA::StatsSnapshot global = portManager.getGlobalSnapshot();
+    CSMA::StatsSnapshot last = portManager.getLastSessionSnapshot();
 
     std::cout << "=== Статистика передачи ===" << std::endl << std::endl;
 
     // Лямбда для красивого вывода
-    auto printStats = [](const std::string& title, const CSMA::Stats& s) {
+    // Среднее и хвост распределения; задержки в мкс переводятся в мс
+    auto printHistogram = [](const std::string& name, const CSMA::HistogramSnapshot& h, double scale) {
+        std::cout << name;
+        if (h.count == 0) {
+            std::cout << "нет данных" << std::endl;
+            return;
+        }
+        std::cout << std::fixed << std::setprecision(1)
+                  << "сред. " << h.mean() / scale
+                  << ", p50 " << h.percentile(0.5) / scale
+                  << ", p99 " << h.percentile(0.99) / scale
+                  << ", макс. " << h.max() / scale << std::endl;
+        };
+
+    auto printStats = [&printHistogram](const std::string& title, const CSMA::StatsSnapshot& snap) {
+        const CSMA::Stats& s = snap.totals;
         std::cout << title << std::endl;
         std::cout << "--------------------------------" << std::endl;
         std::cout << "Передано кадров (успешно): " << s.packets_sent << std::endl;
@@ -272,6 +448,16 @@ void ConsoleInterface::viewStatistics() {
         std::cout << "Случаев занятости канала:  " << s.busy_events << std::endl;
         std::cout << "Количество коллизий:       " << s.collisions << std::endl;
         std::cout << "Отправлено JAM-сигналов:   " << s.jam_sent << std::endl;
+        std::cout << "Повторов по тайм-ауту:     " << s.retransmissions << std::endl;
+        std::cout << "Принято кадров:            " << s.frames_received << std::endl;
+        std::cout << "С неисправимой ошибкой:    " << s.uncorrectable_frames << std::endl;
+        std::cout << "Потеряно (очередь полна):  " << s.queue_overflows << std::endl;
+        std::cout << "FEC: без ошибок / исправлено / неисправимо: " << snap.eccClean << " / "
+                  << snap.eccCorrected << " / " << s.uncorrectable_frames << std::endl;
+        printHistogram("Доступ к каналу, мс:       ", snap.accessDelayUs, 1000.0);
+        printHistogram("Задержка после коллизии, мс: ", snap.backoffDelayUs, 1000.0);
+        printHistogram("Передач на кадр:           ", snap.attemptsPerFrame, 1.0);
+        printHistogram("Отправка кадра, мс:        ", snap.frameLatencyUs, 1000.0);
         std::cout << std::endl;
         };
 
@@ -279,5 +465,134 @@ void ConsoleInterface::viewStatistics() {
     printStats("--- Статистика последней пересылки ---", last);
 
     std::cout << "Нажмите любую клавишу для возврата в меню..." << std::endl;
-    _getch();
-}
\ No newline at end of file
+    ConsolePlatform::waitKey();
+}
+
+void ConsoleInterface::arqSettings() {
+    ConsolePlatform::clearScreen();
+    std::cout << "=== Надежная доставка (ARQ) ===" << std::endl;
+    std::cout << "Текущий режим: " << arqModeName(portManager.getArqMode()) << std::endl << std::endl;
+    std::cout << "1. Выключена" << std::endl;
+    std::cout << "2. Go-Back-N" << std::endl;
+    std::cout << "3. Selective Repeat" << std::endl;
+    std::cout << "Выберите режим (1-3): ";
+    int choice = inputInteger(1, 3);
+
+    ARQ::Mode mode = ARQ::Mode::Off;
+    if (choice == 2) mode = ARQ::Mode::GoBackN;
+    if (choice == 3) mode = ARQ::Mode::SelectiveRepeat;
+
+    int window = 1;
+    if (mode != ARQ::Mode::Off) {
+        int maxWindow = ARQ::max_window(mode);
+        std::cout << "Размер окна (1-" << maxWindow << "): ";
+        window = inputInteger(1, maxWindow);
+    }
+    portManager.setArqMode(mode, window);
+
+    std::cout << "\nРежим: " << arqModeName(mode) << ". Нажмите любую клавишу для продолжения..." << std::endl;
+    ConsolePlatform::waitKey(); rewind(stdin);
+}
+
+void ConsoleInterface::payloadSettings() {
+    ConsolePlatform::clearScreen();
+    std::cout << "=== Размер данных кадра ===" << std::endl;
+    std::cout << "1. Фиксированный" << std::endl;
+    std::cout << "2. Адаптивный (по коллизиям и неисправимым ошибкам)" << std::endl;
+    std::cout << "Выберите режим (1-2): ";
+    int choice = inputInteger(1, 2);
+
+    const int maxPayload = static_cast<int>(PayloadSizer::MAX_PAYLOAD);
+    if (choice == 1) {
+        std::cout << "Размер данных (1-" << maxPayload << "): ";
+        portManager.setFixedPayload(inputInteger(1, maxPayload));
+    }
+    else {
+        std::cout << "Минимальный размер (1-" << maxPayload << ", обычно " << PayloadSizer::ADAPTIVE_MIN << "): ";
+        int minSize = inputInteger(1, maxPayload);
+        std::cout << "Максимальный размер (" << minSize << "-" << maxPayload << ", обычно " << PayloadSizer::ADAPTIVE_MAX << "): ";
+        int maxSize = inputInteger(minSize, maxPayload);
+        portManager.setAdaptivePayload(minSize, maxSize);
+    }
+
+    std::cout << "\nНастройка сохранена. Нажмите любую клавишу для продолжения..." << std::endl;
+    ConsolePlatform::waitKey(); rewind(stdin);
+}
+
+void ConsoleInterface::compressionSettings() {
+    ConsolePlatform::clearScreen();
+    std::cout << "=== Сжатие данных и заголовка ===" << std::endl;
+    std::cout << "Сжатие данных: " << (portManager.getCompressionEnabled() ? "включено" : "выключено")
+              << ", заголовок: " << (portManager.getCompactHeader() ? "сжатый" : "полный") << std::endl << std::endl;
+    std::cout << "Сообщение сжимается перед разбиением на кадры. Несжимаемые и короткие" << std::endl;
+    std::cout << "(меньше " << Lz::MIN_INPUT << " байт) сообщения передаются как есть." << std::endl << std::endl;
+    std::cout << "1. Включить" << std::endl;
+    std::cout << "2. Выключить" << std::endl;
+    std::cout << "Выберите действие (1-2): ";
+    int choice = inputInteger(1, 2);
+    portManager.setCompressionEnabled(choice == 1);
+
+    // Время в сжатом заголовке — разность с опорным кадром, адреса опускаются
+    std::cout << "\nСжатый заголовок кадра (4-6 байт вместо 13)? (1 - да, 0 - нет): ";
+    portManager.setCompactHeader(inputInteger(0, 1) == 1);
+
+    std::cout << "\nНастройка сохранена. Нажмите любую клавишу для продолжения..." << std::endl;
+    ConsolePlatform::waitKey(); rewind(stdin);
+}
+
+void ConsoleInterface::traceSettings() {
+    ConsolePlatform::clearScreen();
+    std::cout << "=== Трассировка протокола ===" << std::endl;
+    std::cout << "Сейчас: " << (Trace::enabled() ? "включена" : "выключена")
+              << ", записей: " << Trace::recordCount() << std::endl << std::endl;
+    std::cout << "1. Включить" << std::endl;
+    std::cout << "2. Выключить" << std::endl;
+    std::cout << "3. Сохранить для chrome://tracing" << std::endl;
+    std::cout << "4. Очистить" << std::endl;
+    std::cout << "Выберите действие (1-4): ";
+    int choice = inputInteger(1, 4);
+
+    switch (choice) {
+    case 1: Trace::setEnabled(true); std::cout << "\nТрассировка включена."; break;
+    case 2: Trace::setEnabled(false); std::cout << "\nТрассировка выключена."; break;
+    case 3: {
+        std::cout << "Имя файла: ";
+        std::string path;
+        std::getline(std::cin, path);
+        if (path.empty()) path = "trace.json";
+        bool wasEnabled = Trace::enabled();
+        Trace::setEnabled(false);
+        std::cout << (Trace::exportChrome(path) ? "\nТрасса сохранена в " + path : "\nНе удалось записать " + path);
+        Trace::setEnabled(wasEnabled);
+        break;
+    }
+    default: Trace::clear(); std::cout << "\nЗаписи удалены."; break;
+    }
+
+    std::cout << " Нажмите любую клавишу для продолжения..." << std::endl;
+    ConsolePlatform::waitKey(); rewind(stdin);
+}
+
+void ConsoleInterface::fecSettings() {
+    ConsolePlatform::clearScreen();
+    std::cout << "=== Помехоустойчивый код ===" << std::endl;
+    std::cout << "Текущий режим: " << fecModeName(portManager.getFecMode()) << std::endl << std::endl;
+    std::cout << "1. Один код на кадр (одна ошибка на кадр, прежний формат)" << std::endl;
+    std::cout << "2. (72,64) на каждые 8 байт (одна ошибка на 8 байт)" << std::endl;
+    std::cout << "3. (72,64) с чередованием битов (пакет до 8 бит на 64 байта)" << std::endl;
+    std::cout << "Выберите режим (1-3): ";
+    int choice = inputInteger(1, 3);
+
+    FecMode mode = FecMode::Whole;
+    if (choice == 2) mode = FecMode::Blocked;
+    if (choice == 3) mode = FecMode::Interleaved;
+    portManager.setFecMode(mode);
+
+    std::cout << "\nДобавлять CRC-32C к кадру? (1 - да, 0 - нет): ";
+    portManager.setCrcEnabled(inputInteger(0, 1) == 1);
+
+    std::cout << "\nРежим: " << fecModeName(mode);
+    if (portManager.getCrcEnabled()) std::cout << " + CRC-32C";
+    std::cout << ". Нажмите любую клавишу для продолжения..." << std::endl;
+    ConsolePlatform::waitKey(); rewind(stdin);
+}
@@ -13,7 +13,9 @@ private:
     };
 
     std::vector<PortPair> availablePortPairs;
-    std::vector<DWORD> baudRates;
+    std::vector<uint32_t> baudRates;
+
+    static const int RECEIVE_WAIT_MS = 1000;
 
     void showMainMenu();
     std::string prettyPrintRawFrame(const std::vector<uint8_t>& stuffed) const;
@@ -23,8 +25,13 @@ private:
     void changeBaudRate();
     void viewLastSentFrame();
     void viewStatistics(); //  
+    void arqSettings();
+    void payloadSettings();
+    void traceSettings();
+    void fecSettings();
+    void compressionSettings();
 
 public:
-    ConsoleInterface();
+    explicit ConsoleInterface(const CSMA::Params& csmaParams = CSMA::Params());
     void run();
 };
\ No newline at end of file
@@ -0,0 +1,54 @@
+﻿#include "ConsolePlatform.h"
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+
+#ifdef _WIN32
+#include <conio.h>
+#include <windows.h>
+#else
+#include <termios.h>
+#include <unistd.h>
+#endif
+
+namespace ConsolePlatform {
+
+    void init() {
+#ifdef _WIN32
+        system("chcp 1251");
+#endif
+        clearScreen();
+    }
+
+    void clearScreen() {
+#ifdef _WIN32
+        system("cls");
+#else
+        std::cout << "\033[2J\033[H" << std::flush;
+#endif
+    }
+
+    int waitKey() {
+#ifdef _WIN32
+        return _getch();
+#else
+        std::cout << std::flush;
+        termios original;
+        if (tcgetattr(STDIN_FILENO, &original) != 0) {
+            return std::getchar();
+        }
+        termios raw = original;
+        raw.c_lflag &= ~(ICANON | ECHO);
+        raw.c_cc[VMIN] = 1;
+        raw.c_cc[VTIME] = 0;
+        tcsetattr(STDIN_FILENO, TCSANOW, &raw);
+
+        unsigned char c = 0;
+        ssize_t n = ::read(STDIN_FILENO, &c, 1);
+
+        tcsetattr(STDIN_FILENO, TCSANOW, &original);
+        return n == 1 ? c : EOF;
+#endif
+    }
+
+}
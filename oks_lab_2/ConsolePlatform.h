@@ -0,0 +1,12 @@
+#pragma once
+
+// -   
+namespace ConsolePlatform {
+    //    (Windows-1251  Windows)
+    void init();
+
+    void clearScreen();
+
+    //        Enter
+    int waitKey();
+}
@@ -0,0 +1,55 @@
+﻿#include "CpuFeatures.h"
+
+#if OKS_ARCH_X86 && defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace {
+    struct Features {
+        bool sse2 = false;
+        bool sse42 = false;
+        bool pclmul = false;
+        bool avx2 = false;
+    };
+
+    Features detect() {
+        Features f;
+#if OKS_ARCH_X86 && defined(_MSC_VER)
+        int regs[4] = { 0 };
+        __cpuid(regs, 0);
+        int max_leaf = regs[0];
+
+        __cpuid(regs, 1);
+        f.sse2 = (regs[3] & (1 << 26)) != 0;
+        f.sse42 = (regs[2] & (1 << 20)) != 0;
+        f.pclmul = (regs[2] & (1 << 1)) != 0;
+        bool osxsave = (regs[2] & (1 << 27)) != 0;
+        bool avx = (regs[2] & (1 << 28)) != 0;
+
+        // AVX2 требует, чтобы ОС сохраняла YMM-регистры
+        if (max_leaf >= 7 && osxsave && avx && (_xgetbv(0) & 0x6) == 0x6) {
+            __cpuidex(regs, 7, 0);
+            f.avx2 = (regs[1] & (1 << 5)) != 0;
+        }
+#elif OKS_ARCH_X86
+        __builtin_cpu_init();
+        f.sse2 = __builtin_cpu_supports("sse2");
+        f.sse42 = __builtin_cpu_supports("sse4.2");
+        f.pclmul = __builtin_cpu_supports("pclmul");
+        f.avx2 = __builtin_cpu_supports("avx2");
+#endif
+        return f;
+    }
+
+    const Features& features() {
+        static const Features f = detect();
+        return f;
+    }
+}
+
+namespace CpuFeatures {
+    bool has_sse2() { return features().sse2; }
+    bool has_sse42() { return features().sse42; }
+    bool has_pclmul() { return features().pclmul; }
+    bool has_avx2() { return features().avx2; }
+}
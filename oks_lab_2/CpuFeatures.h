@@ -0,0 +1,24 @@
+#pragma once
+
+//  x86/x64:  SSE/AVX-
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define OKS_ARCH_X86 1
+#else
+#define OKS_ARCH_X86 0
+#endif
+
+//        .
+// MSVC      .
+#if defined(_MSC_VER) && !defined(__clang__)
+#define OKS_TARGET(isa)
+#else
+#define OKS_TARGET(isa) __attribute__((target(isa)))
+#endif
+
+//      
+namespace CpuFeatures {
+    bool has_sse2();
+    bool has_sse42();
+    bool has_pclmul();
+    bool has_avx2();
+}
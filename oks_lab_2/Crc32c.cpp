@@ -0,0 +1,139 @@
+﻿#include "Crc32c.h"
+#include "CpuFeatures.h"
+#include <cstring>
+
+#if OKS_ARCH_X86
+#include <immintrin.h>
+#endif
+
+// 64-битная форма crc32 есть только в x64
+#if OKS_ARCH_X86 && (defined(_M_X64) || defined(__x86_64__))
+#define OKS_CRC32C_HW 1
+#else
+#define OKS_CRC32C_HW 0
+#endif
+
+namespace {
+    using UpdateFn = uint32_t(*)(uint32_t, const uint8_t*, size_t);
+
+    // Полином в отраженном виде: бит i — коэффициент при x^(31-i)
+    const uint32_t POLY = 0x82F63B78;
+
+    constexpr uint32_t times_x(uint32_t v) {
+        return (v >> 1) ^ (POLY & (0u - (v & 1)));
+    }
+
+    // t[j][v] — CRC байта v, за которым идут j нулевых байтов
+    struct Tables {
+        uint32_t t[8][256]{};
+    };
+
+    constexpr Tables make_tables() {
+        Tables s;
+        for (uint32_t v = 0; v < 256; ++v) {
+            uint32_t c = v;
+            for (int k = 0; k < 8; ++k) {
+                c = times_x(c);
+            }
+            s.t[0][v] = c;
+        }
+        for (int j = 1; j < 8; ++j) {
+            for (uint32_t v = 0; v < 256; ++v) {
+                uint32_t prev = s.t[j - 1][v];
+                s.t[j][v] = (prev >> 8) ^ s.t[0][prev & 0xFF];
+            }
+        }
+        return s;
+    }
+
+    constexpr Tables TABLES = make_tables();
+
+    uint64_t load64(const uint8_t* p) {
+        uint64_t v;
+        std::memcpy(&v, p, sizeof(v)); // little-endian (x86/ARM)
+        return v;
+    }
+
+    // Функции ядер работают с внутренним состоянием: инверсия — в Crc32c::update
+    uint32_t update_slicing8(uint32_t crc, const uint8_t* p, size_t n) {
+        const auto& t = TABLES.t;
+        for (; n >= 8; p += 8, n -= 8) {
+            uint64_t v = load64(p) ^ crc;
+            crc = t[7][v & 0xFF] ^ t[6][(v >> 8) & 0xFF] ^ t[5][(v >> 16) & 0xFF] ^ t[4][(v >> 24) & 0xFF] ^
+                  t[3][(v >> 32) & 0xFF] ^ t[2][(v >> 40) & 0xFF] ^ t[1][(v >> 48) & 0xFF] ^ t[0][v >> 56];
+        }
+        for (; n > 0; ++p, --n) {
+            crc = (crc >> 8) ^ t[0][(crc ^ *p) & 0xFF];
+        }
+        return crc;
+    }
+
+#if OKS_CRC32C_HW
+    OKS_TARGET("sse4.2")
+    uint32_t update_sse42(uint32_t crc, const uint8_t* p, size_t n) {
+        uint64_t c = crc;
+        for (; n >= 8; p += 8, n -= 8) {
+            c = _mm_crc32_u64(c, load64(p));
+        }
+        uint32_t c32 = static_cast<uint32_t>(c);
+        for (; n > 0; ++p, --n) {
+            c32 = _mm_crc32_u8(c32, *p);
+        }
+        return c32;
+    }
+
+    // Три независимых потока прячут задержку crc32 (3 такта). Состояние потока
+    // сдвигается на n нулевых байтов умножением на x^(8n-33) mod P: clmul дает
+    // 64-битное произведение, crc32 от него приводит его по модулю P и домножает на x^33
+    const size_t STREAM_BYTES = 256;
+
+    constexpr uint32_t shift_constant(size_t bytes) {
+        uint32_t v = 0x80000000; // x^0
+        for (size_t i = 0; i < 8 * bytes - 33; ++i) {
+            v = times_x(v);
+        }
+        return v;
+    }
+
+    constexpr uint32_t SHIFT_ONE = shift_constant(STREAM_BYTES);
+    constexpr uint32_t SHIFT_TWO = shift_constant(2 * STREAM_BYTES);
+
+    OKS_TARGET("sse4.2,pclmul")
+    uint32_t update_pclmul(uint32_t crc, const uint8_t* p, size_t n) {
+        uint64_t a = crc;
+        for (; n >= 3 * STREAM_BYTES; p += 3 * STREAM_BYTES, n -= 3 * STREAM_BYTES) {
+            uint64_t b = 0;
+            uint64_t c = 0;
+            for (size_t i = 0; i < STREAM_BYTES; i += 8) {
+                a = _mm_crc32_u64(a, load64(p + i));
+                b = _mm_crc32_u64(b, load64(p + STREAM_BYTES + i));
+                c = _mm_crc32_u64(c, load64(p + 2 * STREAM_BYTES + i));
+            }
+            __m128i sa = _mm_clmulepi64_si128(_mm_cvtsi64_si128(static_cast<long long>(a)), _mm_cvtsi32_si128(static_cast<int>(SHIFT_TWO)), 0);
+            __m128i sb = _mm_clmulepi64_si128(_mm_cvtsi64_si128(static_cast<long long>(b)), _mm_cvtsi32_si128(static_cast<int>(SHIFT_ONE)), 0);
+            uint64_t shifted = static_cast<uint64_t>(_mm_cvtsi128_si64(_mm_xor_si128(sa, sb)));
+            a = c ^ _mm_crc32_u64(0, shifted);
+        }
+        return update_sse42(static_cast<uint32_t>(a), p, n);
+    }
+#endif
+
+    UpdateFn select_kernel() {
+#if OKS_CRC32C_HW
+        if (CpuFeatures::has_sse42() && CpuFeatures::has_pclmul()) return update_pclmul;
+        if (CpuFeatures::has_sse42()) return update_sse42;
+#endif
+        return update_slicing8;
+    }
+
+    UpdateFn kernel() {
+        static const UpdateFn k = select_kernel();
+        return k;
+    }
+}
+
+namespace Crc32c {
+    uint32_t update(uint32_t crc, std::span<const uint8_t> data) {
+        return ~kernel()(~crc, data.data(), data.size());
+    }
+}
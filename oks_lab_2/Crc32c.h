@@ -0,0 +1,14 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <span>
+
+// CRC-32C (Castagnoli,  0x1EDC6F41).     :
+//  crc32  SSE4.2,        
+//  PCLMUL;      slicing-by-8.
+namespace Crc32c {
+    //  CRC: update(update(0, a), b) == update(0, a  b )
+    uint32_t update(uint32_t crc, std::span<const uint8_t> data);
+
+    inline uint32_t compute(std::span<const uint8_t> data) { return update(0, data); }
+}
@@ -0,0 +1,101 @@
+﻿#include "CsmaConfig.h"
+#include <cstdlib>
+#include <fstream>
+
+namespace CSMA {
+
+    namespace {
+        std::string trim(const std::string& text) {
+            size_t begin = text.find_first_not_of(" \t\r\n");
+            if (begin == std::string::npos) return "";
+            size_t end = text.find_last_not_of(" \t\r\n");
+            return text.substr(begin, end - begin + 1);
+        }
+
+        bool parse_int(const std::string& value, int min, int max, int& out) {
+            char* end = nullptr;
+            long v = std::strtol(value.c_str(), &end, 10);
+            if (end == value.c_str() || *end != '\0' || v < min || v > max) return false;
+            out = static_cast<int>(v);
+            return true;
+        }
+
+        bool parse_probability(const std::string& value, double& out) {
+            char* end = nullptr;
+            double v = std::strtod(value.c_str(), &end);
+            if (end == value.c_str() || *end != '\0' || v < 0.0 || v > 1.0) return false;
+            out = v;
+            return true;
+        }
+
+        // При нулевой настойчивости свободный слот пропускался бы всегда
+        // и кадр не ушел бы никогда: допустимо 0 < p <= 1
+        bool parse_persistence(const std::string& value, double& out) {
+            double v = 0.0;
+            if (!parse_probability(value, v) || v <= 0.0) return false;
+            out = v;
+            return true;
+        }
+    }
+
+    const char* backoff_name(BackoffKind kind) {
+        switch (kind) {
+        case BackoffKind::OnePersistent: return "1-persistent";
+        case BackoffKind::PPersistent: return "p-persistent";
+        case BackoffKind::BoundedJitter: return "jitter";
+        default: return "beb";
+        }
+    }
+
+    bool set_param(Params& params, const std::string& rawKey, const std::string& rawValue) {
+        std::string key = trim(rawKey);
+        std::string value = trim(rawValue);
+
+        if (key == "slot_time_ms") return parse_int(value, 1, 10000, params.slotTimeMs);
+        if (key == "max_attempts") return parse_int(value, 1, 1000, params.maxAttempts);
+        if (key == "max_backoff_limit") return parse_int(value, 0, 30, params.maxBackoffLimit);
+        if (key == "jam_length") return parse_int(value, 1, 1024, params.jamLength);
+        if (key == "tx_chunk_ms") return parse_int(value, 1, 1000, params.txChunkMs);
+        if (key == "prob_channel_busy") return parse_probability(value, params.probChannelBusy);
+        if (key == "prob_collision") return parse_probability(value, params.probCollision);
+        if (key == "persistence") return parse_persistence(value, params.persistence);
+        if (key == "jitter_slots") return parse_int(value, 0, 1 << 20, params.jitterSlots);
+        if (key == "backoff") {
+            for (BackoffKind kind : { BackoffKind::TruncatedBinary, BackoffKind::OnePersistent,
+                                      BackoffKind::PPersistent, BackoffKind::BoundedJitter }) {
+                if (value == backoff_name(kind)) {
+                    params.backoff = kind;
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    bool parse_assignment(const std::string& text, Params& params) {
+        size_t eq = text.find('=');
+        if (eq == std::string::npos) return false;
+        return set_param(params, text.substr(0, eq), text.substr(eq + 1));
+    }
+
+    bool load_params(const std::string& path, Params& params, std::string& error) {
+        std::ifstream in(path);
+        if (!in) {
+            error = "не удалось открыть " + path;
+            return false;
+        }
+
+        std::string line;
+        int lineNumber = 0;
+        while (std::getline(in, line)) {
+            lineNumber++;
+            line = trim(line.substr(0, line.find('#')));
+            if (line.empty()) continue;
+            if (!parse_assignment(line, params)) {
+                error = path + ":" + std::to_string(lineNumber) + ": неверная строка '" + line + "'";
+                return false;
+            }
+        }
+        return true;
+    }
+}
@@ -1,5 +1,6 @@
 #pragma once
 #include <cstdint>
+#include <string>
 
 namespace CSMA {
     //  
@@ -8,16 +9,57 @@ namespace CSMA {
     const uint8_t COL = 0x15;
     const uint8_t JAM = 0x18;
 
-    // 
+    //   
     const int SLOT_TIME_MS = 30;
     const int MAX_ATTEMPTS = 16;
     const int MAX_BACKOFF_LIMIT = 10;
     const int JAM_LENGTH = 4;
+    const int TX_CHUNK_MS = 2;      //     
 
     // 
     const double PROB_CHANNEL_BUSY = 0.75;
     const double PROB_COLLISION = 0.1;
 
+    //   attempts-   : r  [0, 2^k], k = min(attempts, limit)
+    inline int backoff_slots(int attempts, int limit, uint32_t random) {
+        int k = attempts < limit ? attempts : limit;
+        return static_cast<int>(random % ((1u << k) + 1));
+    }
+
+    enum class BackoffKind {
+        TruncatedBinary,    //    ,   2^k 
+        OnePersistent,      //     
+        PPersistent,        //      persistence
+        BoundedJitter       //    0..jitterSlots,  
+    };
+
+    //   .    " = "    
+    struct Params {
+        int slotTimeMs = SLOT_TIME_MS;
+        int maxAttempts = MAX_ATTEMPTS;
+        int maxBackoffLimit = MAX_BACKOFF_LIMIT;
+        int jamLength = JAM_LENGTH;
+        int txChunkMs = TX_CHUNK_MS;
+        double probChannelBusy = PROB_CHANNEL_BUSY;
+        double probCollision = PROB_COLLISION;
+        BackoffKind backoff = BackoffKind::TruncatedBinary;
+        double persistence = 0.5;       // 0 < p <= 1
+        int jitterSlots = 4;
+    };
+
+    // : slot_time_ms, max_attempts, max_backoff_limit, jam_length, tx_chunk_ms,
+    // prob_channel_busy, prob_collision, backoff (beb, 1-persistent, p-persistent, jitter),
+    // persistence, jitter_slots. false      
+    bool set_param(Params& params, const std::string& key, const std::string& value);
+
+    //   ,   #  
+    bool load_params(const std::string& path, Params& params, std::string& error);
+
+    //  "="
+    bool parse_assignment(const std::string& text, Params& params);
+
+    const char* backoff_name(BackoffKind kind);
+
     //   
     struct Stats {
         int packets_sent = 0;       //   
@@ -25,5 +67,9 @@ namespace CSMA {
         int collisions = 0;         //    
         int jam_sent = 0;           //    JAM
         int total_attempts = 0;     //     
+        int retransmissions = 0;    //   ARQ
+        int frames_received = 0;    //   
+        int uncorrectable_frames = 0; //     
+        int queue_overflows = 0;    //  -   
     };
 }
\ No newline at end of file
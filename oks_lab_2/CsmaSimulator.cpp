@@ -0,0 +1,176 @@
+﻿#include "CsmaSimulator.h"
+#include <algorithm>
+
+namespace {
+    int64_t ms_to_ns(double ms) {
+        return static_cast<int64_t>(ms * 1e6);
+    }
+}
+
+CsmaSimulator::CsmaSimulator(const Config& cfg) :
+    config(cfg),
+    rng(cfg.seed) {
+    config.stations = std::max(config.stations, 1);
+
+    // 8N1: 10 бит на байт
+    int64_t byteTime = static_cast<int64_t>(10e9 / config.baudRate);
+    frameTime = byteTime * static_cast<int64_t>(config.frameBytes);
+    jamTime = byteTime * config.params.jamLength;
+    slotTime = ms_to_ns(config.params.slotTimeMs);
+    propagation = config.propagationMs < 0.0 ? slotTime / 2 : ms_to_ns(config.propagationMs);
+
+    // Интенсивность одной станции: G кадров за время кадра на всех
+    double perStationRate = config.offeredLoad / (static_cast<double>(frameTime) * config.stations);
+    interArrival = std::exponential_distribution<double>(perStationRate > 0.0 ? perStationRate : 1e-30);
+}
+
+void CsmaSimulator::schedule(int64_t time, EventType type, int station, uint64_t gen) {
+    events.push(Event{ time, type, station, gen });
+}
+
+CsmaSimulator::Result CsmaSimulator::run() {
+    stations.clear();
+    stations.resize(config.stations);
+    for (Station& st : stations) {
+        st.backoff = BackoffStrategy::create(config.params, rng());
+    }
+    transmitters.clear();
+    idleWaiters.clear();
+    events = {};
+    result = Result();
+    delaySumMs = 0.0;
+    completed = 0;
+    generation = 0;
+    freeAt = 0;
+
+    for (int s = 0; s < config.stations; ++s) {
+        schedule(static_cast<int64_t>(interArrival(rng)), EventType::Arrival, s);
+    }
+
+    int64_t now = 0;
+    while (completed < config.frames && !events.empty()) {
+        Event ev = events.top();
+        events.pop();
+        now = ev.time;
+        result.events++;
+
+        switch (ev.type) {
+        case EventType::Arrival: onArrival(now, ev.station); break;
+        case EventType::Attempt: onAttempt(now, ev.station); break;
+        case EventType::TxEnd: onTxEnd(now, ev.generation); break;
+        case EventType::CollisionDetect: onCollisionDetect(now, ev.generation); break;
+        case EventType::ChannelFree: releaseWaiters(now); break;
+        }
+    }
+
+    result.simulatedSeconds = now / 1e9;
+    if (now > 0) {
+        result.throughput = static_cast<double>(result.stats.packets_sent) * frameTime / now;
+    }
+    if (result.stats.packets_sent > 0) {
+        result.meanDelayMs = delaySumMs / result.stats.packets_sent;
+    }
+    return result;
+}
+
+void CsmaSimulator::onArrival(int64_t now, int station) {
+    schedule(now + static_cast<int64_t>(interArrival(rng)), EventType::Arrival, station);
+
+    Station& st = stations[station];
+    if (st.queue.size() >= config.queueLimit) {
+        result.queueDrops++;
+        return;
+    }
+    st.queue.push_back(now);
+    if (st.queue.size() == 1) {
+        onAttempt(now, station);
+    }
+}
+
+void CsmaSimulator::onAttempt(int64_t now, int station) {
+    result.stats.total_attempts++;
+
+    // Чужая передача слышна спустя propagation после ее начала, JAM — до freeAt
+    bool sensedBusy = now < freeAt || (!transmitters.empty() && now >= periodStart + propagation);
+    if (sensedBusy) {
+        result.stats.busy_events++;
+        int slots = stations[station].backoff->busyDelaySlots();
+        if (slots == 0) idleWaiters.push_back(station);
+        else schedule(now + slots * slotTime, EventType::Attempt, station);
+        return;
+    }
+    if (!stations[station].backoff->shouldTransmit()) {
+        schedule(now + slotTime, EventType::Attempt, station);
+        return;
+    }
+
+    if (transmitters.empty()) {
+        periodStart = now;
+        generation++;
+        schedule(now + frameTime, EventType::TxEnd, station, generation);
+    }
+    transmitters.push_back(station);
+
+    // Вторая станция в окне распространения: коллизию услышат через propagation
+    if (transmitters.size() == 2) {
+        schedule(now + propagation, EventType::CollisionDetect, station, generation);
+    }
+}
+
+void CsmaSimulator::onTxEnd(int64_t now, uint64_t gen) {
+    if (gen != generation || transmitters.size() != 1) return;
+
+    int station = transmitters.front();
+    transmitters.clear();
+    generation++;
+
+    Station& st = stations[station];
+    delaySumMs += (now - st.queue.front()) / 1e6;
+    result.stats.packets_sent++;
+    finishFrame(now, station);
+    releaseWaiters(now);
+}
+
+void CsmaSimulator::onCollisionDetect(int64_t now, uint64_t gen) {
+    if (gen != generation) return;
+
+    result.stats.collisions++;
+    freeAt = now + jamTime;
+    generation++; // TxEnd этого периода больше не действует
+
+    for (int station : transmitters) {
+        result.stats.jam_sent++;
+        Station& st = stations[station];
+        st.attempts++;
+        if (st.attempts >= config.params.maxAttempts) {
+            result.dropped++;
+            finishFrame(freeAt, station);
+            continue;
+        }
+        int slots = st.backoff->collisionDelaySlots(st.attempts);
+        schedule(freeAt + slots * slotTime, EventType::Attempt, station);
+    }
+    transmitters.clear();
+    // Станции, услышавшие JAM уже после обнаружения коллизии, тоже ждут
+    // конца JAM: отпускаем их событием в freeAt, а не сейчас
+    schedule(freeAt, EventType::ChannelFree, -1);
+}
+
+// Канал освободился: все, кто его ждал, пытаются одновременно
+void CsmaSimulator::releaseWaiters(int64_t when) {
+    for (int station : idleWaiters) {
+        schedule(when, EventType::Attempt, station);
+    }
+    idleWaiters.clear();
+}
+
+// Кадр станции завершен (передан или отброшен), берем следующий из очереди
+void CsmaSimulator::finishFrame(int64_t now, int station) {
+    Station& st = stations[station];
+    st.queue.pop_front();
+    st.attempts = 0;
+    completed++;
+    if (!st.queue.empty()) {
+        schedule(now, EventType::Attempt, station);
+    }
+}
@@ -0,0 +1,99 @@
+#pragma once
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <queue>
+#include <random>
+#include <vector>
+#include "Backoff.h"
+#include "CsmaConfig.h"
+
+// -  CSMA/CD   .
+// N         ,   sendMessage:
+//   BackoffStrategy ,   JAM, 
+// params.maxAttempts   .    
+//      (1- ).
+//    ,   ,  .
+class CsmaSimulator {
+public:
+    struct Config {
+        int stations = 10;
+        double offeredLoad = 0.5;       // G:      ,   
+        uint32_t baudRate = 9600;
+        size_t frameBytes = 64;         //    
+        CSMA::Params params;            // , JAM,  , 
+        double propagationMs = -1.0;    // ,       ; < 0  
+        uint64_t frames = 1000000;      //      (  )
+        size_t queueLimit = 64;         //  ;   
+        uint64_t seed = 1;
+    };
+
+    struct Result {
+        CSMA::Stats stats;
+        uint64_t dropped = 0;           //   
+        uint64_t queueDrops = 0;        //     
+        uint64_t events = 0;
+        double simulatedSeconds = 0.0;
+        double throughput = 0.0;        // S:      
+        double meanDelayMs = 0.0;       //       
+    };
+
+    explicit CsmaSimulator(const Config& config);
+
+    Result run();
+
+private:
+    enum class EventType : uint8_t {
+        Arrival,
+        Attempt,
+        TxEnd,
+        CollisionDetect,
+        ChannelFree         //  JAM:     
+    };
+
+    struct Event {
+        int64_t time;
+        EventType type;
+        int station;
+        uint64_t generation;    // TxEnd  CollisionDetect     
+
+        bool operator>(const Event& other) const { return time > other.time; }
+    };
+
+    struct Station {
+        std::deque<int64_t> queue;  //   
+        int attempts = 0;           //   
+        std::unique_ptr<BackoffStrategy> backoff;
+    };
+
+    Config config;
+    std::mt19937_64 rng;
+    std::exponential_distribution<double> interArrival;
+
+    int64_t frameTime = 0;
+    int64_t slotTime = 0;
+    int64_t jamTime = 0;
+    int64_t propagation = 0;
+
+    std::priority_queue<Event, std::vector<Event>, std::greater<Event>> events;
+    std::vector<Station> stations;
+
+    //  
+    std::vector<int> transmitters;
+    std::vector<int> idleWaiters;   //   
+    int64_t periodStart = 0;
+    int64_t freeAt = 0;         //  JAM  
+    uint64_t generation = 0;
+
+    Result result;
+    double delaySumMs = 0.0;
+    uint64_t completed = 0;
+
+    void schedule(int64_t time, EventType type, int station, uint64_t gen = 0);
+    void onArrival(int64_t now, int station);
+    void onAttempt(int64_t now, int station);
+    void onTxEnd(int64_t now, uint64_t gen);
+    void onCollisionDetect(int64_t now, uint64_t gen);
+    void finishFrame(int64_t now, int station);
+    void releaseWaiters(int64_t when);
+};
@@ -0,0 +1,106 @@
+﻿#include "FecHarness.h"
+#include "Crc32c.h"
+#include "HammingBlock.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <random>
+#include <thread>
+
+namespace {
+    struct Counters {
+        uint64_t clean = 0;
+        uint64_t corrected = 0;
+        uint64_t detected = 0;
+        uint64_t miscorrected = 0;
+    };
+
+    // Разводит зерна потоков (SplitMix64)
+    uint64_t mix_seed(uint64_t x) {
+        x += 0x9E3779B97F4A7C15ull;
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+        return x ^ (x >> 31);
+    }
+
+    void run_trials(uint64_t trials, size_t payloadSize, const ChannelNoise::Model& model,
+                    bool distortFcs, FecMode mode, bool crc, uint64_t seed, Counters& out) {
+        std::mt19937 rng(static_cast<uint32_t>(seed ^ (seed >> 32)));
+
+        size_t fcsSize = HammingBlock::fcs_size(payloadSize, mode);
+        std::vector<uint8_t> original(payloadSize);
+        // Данные и FCS подряд, чтобы искажение могло задеть оба поля
+        std::vector<uint8_t> codeword(payloadSize + fcsSize);
+        std::span<uint8_t> data(codeword.data(), payloadSize);
+        std::span<uint8_t> fcs(codeword.data() + payloadSize, fcsSize);
+
+        Counters local;
+        for (uint64_t t = 0; t < trials; ++t) {
+            for (size_t i = 0; i < payloadSize; i += 4) {
+                uint32_t word = rng();
+                std::memcpy(original.data() + i, &word, std::min<size_t>(4, payloadSize - i));
+            }
+            std::memcpy(data.data(), original.data(), payloadSize);
+            HammingBlock::generate_fcs_into(data, fcs, mode);
+            uint32_t expectedCrc = crc ? Crc32c::compute(original) : 0;
+
+            size_t flipped = model.apply(distortFcs ? std::span<uint8_t>(codeword) : data, rng);
+
+            HammingStatus status = HammingBlock::correct_in_place(data, fcs, mode);
+            if (crc && status != HammingStatus::DoubleDetected && Crc32c::compute(data) != expectedCrc) {
+                status = HammingStatus::DoubleDetected;
+            }
+            bool intact = std::memcmp(data.data(), original.data(), payloadSize) == 0;
+
+            if (status == HammingStatus::DoubleDetected) local.detected++;
+            else if (!intact) local.miscorrected++;
+            else if (flipped == 0) local.clean++;
+            else local.corrected++;
+        }
+        out = local;
+    }
+}
+
+FecHarness::Result FecHarness::runPoint(const Config& config, size_t payloadSize, const ChannelNoise::Model& model) {
+    unsigned threads = config.threads ? config.threads : std::max(1u, std::thread::hardware_concurrency());
+    threads = static_cast<unsigned>(std::min<uint64_t>(threads, std::max<uint64_t>(config.trials, 1)));
+
+    std::vector<Counters> counters(threads);
+    std::vector<std::thread> workers;
+    workers.reserve(threads);
+
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned i = 0; i < threads; ++i) {
+        uint64_t share = config.trials / threads + (i < config.trials % threads ? 1 : 0);
+        uint64_t seed = mix_seed(config.seed * 0x100000001B3ull + payloadSize * 131 + i);
+        workers.emplace_back(run_trials, share, payloadSize, std::cref(model), config.distortFcs, config.mode, config.crc, seed, std::ref(counters[i]));
+    }
+    for (auto& w : workers) w.join();
+
+    Result result;
+    result.payloadSize = payloadSize;
+    result.model = model;
+    result.trials = config.trials;
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    for (const Counters& c : counters) {
+        result.clean += c.clean;
+        result.corrected += c.corrected;
+        result.detected += c.detected;
+        result.miscorrected += c.miscorrected;
+    }
+    if (result.seconds > 0.0) {
+        result.megabytesPerSecond = static_cast<double>(config.trials) * payloadSize / result.seconds / 1e6;
+    }
+    return result;
+}
+
+std::vector<FecHarness::Result> FecHarness::run(const Config& config) {
+    std::vector<Result> results;
+    results.reserve(config.payloadSizes.size() * config.models.size());
+    for (const ChannelNoise::Model& model : config.models) {
+        for (size_t size : config.payloadSizes) {
+            results.push_back(runPoint(config, size, model));
+        }
+    }
+    return results;
+}
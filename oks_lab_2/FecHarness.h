@@ -0,0 +1,37 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include "ChannelNoise.h"
+#include "HammingBlock.h"
+
+// -  FEC:  ->  -> .
+//      ,     .
+class FecHarness {
+public:
+    struct Config {
+        std::vector<size_t> payloadSizes;
+        std::vector<ChannelNoise::Model> models;
+        uint64_t trials = 200000;       //    (, )
+        unsigned threads = 0;           // 0   
+        uint64_t seed = 1;
+        bool distortFcs = false;        //   ,  FCS
+        FecMode mode = FecMode::Whole;
+        bool crc = false;               // CRC-32C  FCS,   
+    };
+
+    struct Result {
+        size_t payloadSize = 0;
+        ChannelNoise::Model model;
+        uint64_t trials = 0;
+        uint64_t clean = 0;             //   
+        uint64_t corrected = 0;         //   
+        uint64_t detected = 0;          //         CRC
+        uint64_t miscorrected = 0;      //  ,     
+        double seconds = 0.0;
+        double megabytesPerSecond = 0.0; //    ,   
+    };
+
+    static Result runPoint(const Config& config, size_t payloadSize, const ChannelNoise::Model& model);
+    static std::vector<Result> run(const Config& config);
+};
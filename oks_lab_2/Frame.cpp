@@ -1,99 +1,190 @@
 #include "Frame.h"
 #include "HammingBlock.h"
+#include "ByteStuffing.h"
+#include "Crc32c.h"
+#include <algorithm>
 #include <chrono>
 
-static const uint8_t ESC = 0x1B;
-static const uint8_t START_FLAG = 0x08;
-static const uint8_t END_FLAG = 0x7E;
+static const uint8_t START_FLAG = ByteStuffing::START_FLAG;
+static const uint8_t END_FLAG = ByteStuffing::END_FLAG;
+static const uint8_t ESC = ByteStuffing::ESC;
 
-std::vector<uint8_t> Frame::create_frame() const {
-    std::vector<uint8_t> out;
-    out.push_back(START_FLAG);
+bool Frame::supported_flags(uint8_t flags) {
+    return (flags & ~KNOWN_FLAGS) == 0 &&
+        (flags & FLAG_FEC_MASK) <= static_cast<uint8_t>(FecMode::Interleaved);
+}
 
-    std::vector<uint8_t> inner;
-    inner.push_back(sender);
-    inner.push_back(receiver);
+size_t Frame::max_encoded_size(size_t dataLen) {
+    //   FCS  ;      1  2 , CRC  4
+    size_t inner = 1 + MAX_HEADER_SIZE + dataLen + HammingBlock::fcs_size(dataLen, FecMode::Interleaved) + CRC_SIZE;
+    return 4 + ByteStuffing::max_stuffed_size(inner);
+}
+
+void Frame::write_header(uint8_t* out) const {
+    size_t idx = 0;
+    out[idx++] = sender;
+    out[idx++] = receiver;
 
     for (int i = 0; i < 8; ++i) {
-        inner.push_back(static_cast<uint8_t>((timestamp >> (i * 8)) & 0xFF));
+        out[idx++] = static_cast<uint8_t>((timestamp >> (i * 8)) & 0xFF);
     }
 
-    inner.push_back(seqNumber);
-    inner.push_back(static_cast<uint8_t>((dataLen >> 8) & 0xFF));
-    inner.push_back(static_cast<uint8_t>(dataLen & 0xFF));
-    inner.insert(inner.end(), data.begin(), data.end());
+    out[idx++] = seqNumber;
+    out[idx++] = static_cast<uint8_t>((dataLen >> 8) & 0xFF);
+    out[idx++] = static_cast<uint8_t>(dataLen & 0xFF);
+}
 
-    std::vector<uint8_t> fcs_bytes = HammingBlock::generate_fcs(data);
-    inner.insert(inner.end(), fcs_bytes.begin(), fcs_bytes.end());
+uint32_t Frame::compute_crc(std::span<const uint8_t> payload) const {
+    uint8_t header[HEADER_SIZE];
+    write_header(header);
+    uint32_t c = Crc32c::compute(std::span<const uint8_t>(&flags, 1));
+    c = Crc32c::update(c, header);
+    return Crc32c::update(c, payload);
+}
 
-    byte_stufing(inner, START_FLAG, END_FLAG, out);
+bool Frame::crc_matches() const {
+    return !hasCrc() || compute_crc(std::span<const uint8_t>(data.data(), data.size())) == crc;
+}
 
-    out.push_back(END_FLAG);
-    return out;
+HammingStatus Frame::correct_in_place() {
+    HammingStatus status = HammingBlock::correct_in_place(data, fcs, fecMode());
+    if (status != HammingStatus::DoubleDetected && !crc_matches()) {
+        return HammingStatus::DoubleDetected;
+    }
+    return status;
+}
+
+HammingStatus Frame::check() const {
+    HammingStatus status = HammingBlock::check(data, fcs, fecMode());
+    if (!hasCrc() || status == HammingStatus::DoubleDetected) return status;
+    if (status == HammingStatus::Clean) {
+        return crc_matches() ? status : HammingStatus::DoubleDetected;
+    }
+
+    // CRC     
+    SmallBuffer<INLINE_DATA_SIZE> corrected(data);
+    HammingBlock::correct_in_place(std::span<uint8_t>(corrected.data(), corrected.size()), fcs, fecMode());
+    return compute_crc(std::span<const uint8_t>(corrected.data(), corrected.size())) == crc ? status : HammingStatus::DoubleDetected;
 }
 
-void Frame::byte_stufing(const std::vector<uint8_t>& inner, const uint8_t START_FLAG, const uint8_t END_FLAG, std::vector<uint8_t>& out) const {
-    for (uint8_t b : inner) {
-        if (b == START_FLAG || b == ESC || b == END_FLAG) {
-            out.push_back(ESC);
-            out.push_back(b ^ 0x20);
+size_t Frame::encode_into(std::span<uint8_t> out, CompactHeader::Encoder* headers) const {
+    if (out.size() < max_encoded_size(data.size())) return 0;
+
+    uint8_t header[MAX_HEADER_SIZE];
+    size_t header_len = HEADER_SIZE;
+    if (!hasCompactHeader()) write_header(header);
+    else if (headers) header_len = headers->write(*this, header);
+    else header_len = CompactHeader::write_reference(*this, 0, header);
+
+    // ,   FCS     
+    uint8_t* p = out.data();
+    *p++ = START_FLAG;
+    if (flags != 0) {
+        *p++ = ESC;
+        *p++ = FORMAT_MARK;
+        p += ByteStuffing::stuff(std::span<const uint8_t>(&flags, 1), p);
+    }
+    p += ByteStuffing::stuff(std::span<const uint8_t>(header, header_len), p);
+    p += ByteStuffing::stuff(data, p);
+
+    //    FCS    ,     
+    uint8_t fcs_bytes[INLINE_FCS_SIZE];
+    FecMode mode = fecMode();
+    if (mode == FecMode::Whole) {
+        size_t fcs_len = HammingBlock::generate_fcs_into(data, fcs_bytes);
+        p += ByteStuffing::stuff(std::span<const uint8_t>(fcs_bytes, fcs_len), p);
+    }
+    else {
+        std::span<const uint8_t> payload(data.data(), data.size());
+        for (size_t offset = 0; offset < payload.size(); offset += HammingBlock::FEC_GROUP_BYTES) {
+            auto group = payload.subspan(offset, std::min(HammingBlock::FEC_GROUP_BYTES, payload.size() - offset));
+            size_t fcs_len = HammingBlock::generate_fcs_into(group, fcs_bytes, mode);
+            p += ByteStuffing::stuff(std::span<const uint8_t>(fcs_bytes, fcs_len), p);
         }
-        else {
-            out.push_back(b);
+    }
+
+    if (hasCrc()) {
+        uint32_t value = compute_crc(std::span<const uint8_t>(data.data(), data.size()));
+        uint8_t crc_bytes[CRC_SIZE];
+        for (size_t i = 0; i < CRC_SIZE; ++i) {
+            crc_bytes[i] = static_cast<uint8_t>(value >> (i * 8));
         }
+        p += ByteStuffing::stuff(crc_bytes, p);
     }
+    *p++ = END_FLAG;
+
+    return static_cast<size_t>(p - out.data());
 }
 
-bool Frame::parse_from_unstuffed(const std::vector<uint8_t>& buf, Frame& outFrame) {
-    if (buf.size() < 13) return false;
-    size_t idx = 0;
-    outFrame.sender = buf[idx++];
-    outFrame.receiver = buf[idx++];
+std::vector<uint8_t> Frame::create_frame() const {
+    std::vector<uint8_t> out(max_encoded_size(data.size()));
+    out.resize(encode_into(out));
+    return out;
+}
 
-    outFrame.timestamp = 0;
-    for (int i = 0; i < 8; ++i) {
-        outFrame.timestamp |= static_cast<uint64_t>(buf[idx++]) << (i * 8);
+bool Frame::parse_from_unstuffed(const std::vector<uint8_t>& buf, bool extended, Frame& outFrame, CompactHeader::Decoder& headers) {
+    size_t idx = 0;
+    outFrame.flags = 0;
+    if (extended) {
+        if (buf.empty() || !supported_flags(buf[0])) return false;
+        outFrame.flags = buf[idx++];
     }
+    if (outFrame.hasCompactHeader()) {
+        size_t used = 0;
+        if (headers.read(buf.data() + idx, buf.size() - idx, outFrame, used) != CompactHeader::Result::Ok) return false;
+        idx += used;
+    }
+    else {
+        if (buf.size() < idx + HEADER_SIZE) return false;
+        outFrame.sender = buf[idx++];
+        outFrame.receiver = buf[idx++];
+
+        outFrame.timestamp = 0;
+        for (int i = 0; i < 8; ++i) {
+            outFrame.timestamp |= static_cast<uint64_t>(buf[idx++]) << (i * 8);
+        }
 
-    outFrame.seqNumber = buf[idx++];
-    outFrame.dataLen = (static_cast<uint16_t>(buf[idx]) << 8) | static_cast<uint16_t>(buf[idx + 1]);
-    idx += 2;
-
-    int data_bits_count = outFrame.dataLen * 8;
-    int p = 0;
-    if (data_bits_count > 0) {
-        while ((1 << p) < (data_bits_count + p + 1)) p++;
+        outFrame.seqNumber = buf[idx++];
+        outFrame.dataLen = (static_cast<uint16_t>(buf[idx]) << 8) | static_cast<uint16_t>(buf[idx + 1]);
+        idx += 2;
     }
-    size_t fcs_size_bytes = (p + 1 + 7) / 8;
 
-    if (idx + outFrame.dataLen + fcs_size_bytes > buf.size()) return false;
+    size_t fcs_size_bytes = HammingBlock::fcs_size(outFrame.dataLen, outFrame.fecMode());
+    size_t crc_size_bytes = outFrame.hasCrc() ? CRC_SIZE : 0;
+
+    if (idx + outFrame.dataLen + fcs_size_bytes + crc_size_bytes > buf.size()) return false;
 
     outFrame.data.assign(buf.begin() + idx, buf.begin() + idx + outFrame.dataLen);
     idx += outFrame.dataLen;
     outFrame.fcs.assign(buf.begin() + idx, buf.begin() + idx + fcs_size_bytes);
+    idx += fcs_size_bytes;
+
+    outFrame.crc = 0;
+    for (size_t i = 0; i < crc_size_bytes; ++i) {
+        outFrame.crc |= static_cast<uint32_t>(buf[idx + i]) << (i * 8);
+    }
 
     return true;
 }
 
-bool Frame::de_byte_stuffing(const std::vector<uint8_t>& raw, Frame& outFrame) {
-    std::vector<uint8_t> unstuffed;
+bool Frame::de_byte_stuffing(const std::vector<uint8_t>& raw, Frame& outFrame, CompactHeader::Decoder* headers) {
     if (raw.size() < 2) return false;
 
     //    (  ,     )
     size_t start_idx = 0;
     while (start_idx < raw.size() && raw[start_idx] == START_FLAG) start_idx++;
 
+    bool extended = start_idx + 1 < raw.size() && raw[start_idx] == ESC && raw[start_idx + 1] == FORMAT_MARK;
+    if (extended) start_idx += 2;
+
     //       
-    size_t i = start_idx;
-    while (i < raw.size()) {
-        uint8_t b = raw[i++];
-        if (b == END_FLAG) break; //  
-
-        if (b == ESC) {
-            if (i >= raw.size()) return false;
-            b = raw[i++] ^ 0x20;
-        }
-        unstuffed.push_back(b);
-    }
-    return parse_from_unstuffed(unstuffed, outFrame);
+    std::span<const uint8_t> body(raw.data() + start_idx, raw.size() - start_idx);
+    std::vector<uint8_t> unstuffed(body.size());
+    size_t written = 0;
+    if (!ByteStuffing::unstuff(body, unstuffed.data(), written)) return false;
+    unstuffed.resize(written);
+
+    if (headers) return parse_from_unstuffed(unstuffed, extended, outFrame, *headers);
+    CompactHeader::Decoder local;
+    return parse_from_unstuffed(unstuffed, extended, outFrame, local);
 }
\ No newline at end of file
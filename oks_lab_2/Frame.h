@@ -1,21 +1,80 @@
 #pragma once
 #include <cstdint>
 #include <vector>
+#include <span>
+#include "CompactHeader.h"
+#include "HammingBlock.h"
+#include "SmallBuffer.h"
 
 struct Frame {
+    //   32   FCS   ,  
+    static const size_t INLINE_DATA_SIZE = 32;
+    static const size_t INLINE_FCS_SIZE = 8;
+    static const size_t HEADER_SIZE = 13;
+    //       
+    static const size_t MAX_HEADER_SIZE = CompactHeader::MAX_SIZE;
+    static_assert(MAX_HEADER_SIZE >= HEADER_SIZE, "MAX_HEADER_SIZE must cover the full header");
+
+    //  :  START_FLAG  ESC  FORMAT_MARK ( 
+    //   ),      .
+    //     -,     
+    static const uint8_t FORMAT_MARK = 0x56;
+    static const uint8_t FLAG_FEC_MASK = 0x03;      // FecMode
+    static const uint8_t FLAG_CRC32C = 0x04;        //  FCS  CRC-32C ,   
+    static const uint8_t FLAG_COMPRESSED = 0x08;    //      (Lz)
+    static const uint8_t FLAG_COMPACT = 0x10;       //    CompactHeader
+    static const uint8_t KNOWN_FLAGS = FLAG_FEC_MASK | FLAG_CRC32C | FLAG_COMPRESSED | FLAG_COMPACT;
+    static const size_t CRC_SIZE = 4;
+
     uint8_t sender;
     uint8_t receiver;
     uint64_t timestamp;
     uint8_t seqNumber;
     uint16_t dataLen;
+    uint8_t flags = 0;
+    uint32_t crc = 0;       //  CRC-32C,   FLAG_CRC32C
+
+    SmallBuffer<INLINE_DATA_SIZE> data;
+    SmallBuffer<INLINE_FCS_SIZE> fcs;
+
+    FecMode fecMode() const { return static_cast<FecMode>(flags & FLAG_FEC_MASK); }
+    void setFecMode(FecMode mode) { flags = static_cast<uint8_t>((flags & ~FLAG_FEC_MASK) | static_cast<uint8_t>(mode)); }
+
+    bool hasCrc() const { return (flags & FLAG_CRC32C) != 0; }
+    void setCrc(bool on) { flags = static_cast<uint8_t>(on ? flags | FLAG_CRC32C : flags & ~FLAG_CRC32C); }
+
+    bool isCompressed() const { return (flags & FLAG_COMPRESSED) != 0; }
+    void setCompressed(bool on) { flags = static_cast<uint8_t>(on ? flags | FLAG_COMPRESSED : flags & ~FLAG_COMPRESSED); }
+
+    bool hasCompactHeader() const { return (flags & FLAG_COMPACT) != 0; }
+    void setCompactHeader(bool on) { flags = static_cast<uint8_t>(on ? flags | FLAG_COMPACT : flags & ~FLAG_COMPACT); }
+
+    // CRC-32C ,       payload
+    uint32_t compute_crc(std::span<const uint8_t> payload) const;
+    // true,  CRC      
+    bool crc_matches() const;
+
+    //    FCS   CRC.  CRC   
+    //  :      SECDED    
+    HammingStatus correct_in_place();
+    //     
+    HammingStatus check() const;
+
+    // ,     
+    static bool supported_flags(uint8_t flags);
+
+    //        (  )
+    static size_t max_encoded_size(size_t dataLen);
 
-    std::vector<uint8_t> data;
-    std::vector<uint8_t> fcs;
+    //    out   .    0,  out  max_encoded_size.
+    //      (headers == nullptr)  
+    size_t encode_into(std::span<uint8_t> out, CompactHeader::Encoder* headers = nullptr) const;
 
     std::vector<uint8_t> create_frame() const;
-    static bool de_byte_stuffing(const std::vector<uint8_t>& raw, Frame& outFrame);
+    //        
+    static bool de_byte_stuffing(const std::vector<uint8_t>& raw, Frame& outFrame, CompactHeader::Decoder* headers = nullptr);
 
 private:
-    void byte_stufing(const std::vector<uint8_t>& inner, const uint8_t START_FLAG, const uint8_t END_FLAG, std::vector<uint8_t>& out) const;
-    static bool parse_from_unstuffed(const std::vector<uint8_t>& buf, Frame& outFrame);
+    void write_header(uint8_t* out) const;
+    static bool parse_from_unstuffed(const std::vector<uint8_t>& buf, bool extended, Frame& outFrame, CompactHeader::Decoder& headers);
 };
\ No newline at end of file
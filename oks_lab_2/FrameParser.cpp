@@ -0,0 +1,189 @@
+﻿#include "FrameParser.h"
+#include "ByteStuffing.h"
+#include "HammingBlock.h"
+#include <algorithm>
+#include <utility>
+
+static const uint8_t START_FLAG = ByteStuffing::START_FLAG;
+static const uint8_t ESC = ByteStuffing::ESC;
+static const uint8_t END_FLAG = ByteStuffing::END_FLAG;
+
+FrameParser::FrameParser(FrameHandler onFrame) :
+    handler(std::move(onFrame)) {
+}
+
+void FrameParser::setHandler(FrameHandler onFrame) {
+    handler = std::move(onFrame);
+}
+
+void FrameParser::reset() {
+    if (state != State::Idle) {
+        dropped++;
+    }
+    state = State::Idle;
+    escaped = false;
+}
+
+void FrameParser::beginFrame() {
+    if (state != State::Idle) {
+        dropped++; // новый START_FLAG внутри незаконченного кадра
+    }
+    state = State::Header;
+    escaped = false;
+    extended = false;
+    headerPos = 0;
+    frame.flags = 0;
+}
+
+void FrameParser::finishFrame() {
+    if (state == State::Trailer && !escaped) {
+        state = State::Idle;
+        if (handler) handler(frame);
+        return;
+    }
+    reset();
+}
+
+void FrameParser::parseHeader() {
+    size_t idx = 0;
+    frame.sender = header[idx++];
+    frame.receiver = header[idx++];
+
+    frame.timestamp = 0;
+    for (int i = 0; i < 8; ++i) {
+        frame.timestamp |= static_cast<uint64_t>(header[idx++]) << (i * 8);
+    }
+
+    frame.seqNumber = header[idx++];
+    frame.dataLen = (static_cast<uint16_t>(header[idx]) << 8) | static_cast<uint16_t>(header[idx + 1]);
+    beginBody();
+}
+
+void FrameParser::beginBody() {
+    frame.data.clear();
+    frame.data.reserve(frame.dataLen, pool);
+    frame.fcs.clear();
+    frame.crc = 0;
+    crcPos = 0;
+    fcsExpected = HammingBlock::fcs_size(frame.dataLen, frame.fecMode());
+    frame.fcs.reserve(fcsExpected, pool);
+}
+
+void FrameParser::advanceAfterHeader() {
+    if (frame.data.size() < frame.dataLen) {
+        state = State::Data;
+    }
+    else if (frame.fcs.size() < fcsExpected) {
+        state = State::Fcs;
+    }
+    else if (frame.hasCrc() && crcPos < Frame::CRC_SIZE) {
+        state = State::Crc;
+    }
+    else {
+        state = State::Trailer;
+    }
+}
+
+size_t FrameParser::bodyBytesLeft() const {
+    if (state != State::Data && state != State::Fcs && state != State::Crc) return 0;
+    size_t crcLeft = frame.hasCrc() ? Frame::CRC_SIZE - crcPos : 0;
+    return (frame.dataLen - frame.data.size()) + (fcsExpected - frame.fcs.size()) + crcLeft;
+}
+
+void FrameParser::acceptByte(uint8_t b) {
+    switch (state) {
+    case State::Flags:
+        if (!Frame::supported_flags(b)) {
+            reset(); // формат новее нашего
+            return;
+        }
+        frame.flags = b;
+        state = State::Header;
+        break;
+    case State::Header:
+        header[headerPos++] = b;
+        if (frame.hasCompactHeader()) {
+            // Длина сжатого заголовка известна, только когда он разобран
+            size_t used = 0;
+            CompactHeader::Result r = headers.read(header, headerPos, frame, used);
+            if (r == CompactHeader::Result::Error) {
+                reset();
+                return;
+            }
+            if (r == CompactHeader::Result::Ok) {
+                beginBody();
+                advanceAfterHeader();
+            }
+        }
+        else if (headerPos == Frame::HEADER_SIZE) {
+            parseHeader();
+            advanceAfterHeader();
+        }
+        break;
+    case State::Data:
+        frame.data.push_back(b);
+        advanceAfterHeader();
+        break;
+    case State::Fcs:
+        frame.fcs.push_back(b);
+        advanceAfterHeader();
+        break;
+    case State::Crc:
+        frame.crc |= static_cast<uint32_t>(b) << (crcPos++ * 8);
+        advanceAfterHeader();
+        break;
+    default:
+        break; // лишние байты перед END_FLAG игнорируются
+    }
+}
+
+void FrameParser::push(uint8_t b) {
+    if (b == START_FLAG) {
+        beginFrame();
+        return;
+    }
+    if (state == State::Idle) return;
+
+    if (b == END_FLAG) {
+        finishFrame();
+        return;
+    }
+    if (escaped) {
+        escaped = false;
+        // Метка формата стоит сразу за START_FLAG, в заголовке стаффинг ее не порождает
+        if (b == Frame::FORMAT_MARK && state == State::Header && headerPos == 0 && !extended) {
+            extended = true;
+            state = State::Flags;
+            return;
+        }
+        acceptByte(b ^ 0x20);
+        return;
+    }
+    if (b == ESC) {
+        escaped = true;
+        return;
+    }
+    acceptByte(b);
+}
+
+void FrameParser::feed(std::span<const uint8_t> chunk) {
+    const uint8_t* p = chunk.data();
+    const uint8_t* end = p + chunk.size();
+
+    while (p < end) {
+        // Быстрый путь: непрерывный участок данных копируется целиком
+        if (state == State::Data && !escaped) {
+            size_t need = frame.dataLen - frame.data.size();
+            const uint8_t* runEnd = p + std::min<size_t>(need, static_cast<size_t>(end - p));
+            const uint8_t* q = p;
+            while (q < runEnd && *q != START_FLAG && *q != ESC && *q != END_FLAG) ++q;
+            if (q != p) {
+                frame.data.append(p, static_cast<size_t>(q - p));
+                advanceAfterHeader();
+                p = q;
+                continue;
+            }
+        }
+        push(*p++);
+    }
+}
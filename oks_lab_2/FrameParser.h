@@ -0,0 +1,75 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+#include <span>
+#include "BufferPool.h"
+#include "Frame.h"
+
+//   .    , 
+//       ,     .
+//   FCS      : ,  ,
+//    ,         .
+class FrameParser {
+public:
+    //      std::move
+    using FrameHandler = std::function<void(Frame&)>;
+
+    explicit FrameParser(FrameHandler onFrame = nullptr);
+
+    void setHandler(FrameHandler onFrame);
+
+    //    
+    void feed(std::span<const uint8_t> chunk);
+
+    //   
+    void push(uint8_t byte);
+
+    //   
+    void reset();
+    //      ( )
+    void resetHeaders() { headers.reset(); }
+
+    bool inFrame() const { return state != State::Idle; }
+    //      :     
+    bool collectingFields() const { return state != State::Idle && state != State::Trailer; }
+    //    (, FCS, CRC)   ; 0  .
+    //        ,    
+    //    feed,     
+    size_t bodyBytesLeft() const;
+    size_t droppedFrames() const { return dropped; }
+    const BufferPool& bufferPool() const { return pool; }
+
+private:
+    enum class State {
+        Idle,    //  START_FLAG
+        Flags,   //    
+        Header,
+        Data,
+        Fcs,
+        Crc,     // CRC-32C,   FLAG_CRC32C
+        Trailer  //   ,  END_FLAG
+    };
+
+    FrameHandler handler;
+    State state = State::Idle;
+    bool escaped = false;
+    bool extended = false;   //      
+
+    uint8_t header[Frame::MAX_HEADER_SIZE];
+    size_t headerPos = 0;
+    size_t fcsExpected = 0;
+    size_t crcPos = 0;
+    Frame frame;
+    CompactHeader::Decoder headers;
+    BufferPool pool;
+
+    size_t dropped = 0;
+
+    void beginFrame();
+    void finishFrame();
+    void acceptByte(uint8_t b);
+    void parseHeader();
+    void beginBody();
+    void advanceAfterHeader();
+};
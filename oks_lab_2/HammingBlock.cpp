@@ -1,177 +1,474 @@
 #include "HammingBlock.h"
-#include <numeric>
 #include <algorithm>
-#include <stdexcept>
+#include <bit>
+#include <cstring>
 
 // ---       ---
+//
+//      1.      1, 2, 4, ...,
+//   (   )     .
+//   j  XOR   ,      j,
+//   p     XOR     .
 namespace {
-    bool get_bit(const std::vector<uint8_t>& bytes, int bit_position) {
-        if (bit_position < 0) {
-            return false;
+    //   0..63,     t (t = 0..5)
+    const uint64_t INDEX_BIT_MASKS[6] = {
+        0xAAAAAAAAAAAAAAAAull,
+        0xCCCCCCCCCCCCCCCCull,
+        0xF0F0F0F0F0F0F0F0ull,
+        0xFF00FF00FF00FF00ull,
+        0xFFFF0000FFFF0000ull,
+        0xFFFFFFFF00000000ull,
+    };
+
+    int parity_bit_count(size_t data_bits_count) {
+        int p = 0;
+        while ((static_cast<size_t>(1) << p) < data_bits_count + p + 1) {
+            p++;
+        }
+        return p;
+    }
+
+    //  count (<= 64)  ,    bit_position
+    uint64_t load_bits(const uint8_t* bytes, size_t size, size_t bit_position, unsigned count) {
+        size_t byte_index = bit_position / 8;
+        unsigned shift = bit_position % 8;
+
+        uint8_t window[9];
+        const uint8_t* src = bytes + byte_index;
+        if (byte_index + sizeof(window) > size) {
+            size_t available = size - byte_index;
+            std::memset(window, 0, sizeof(window));
+            std::memcpy(window, src, available);
+            src = window;
+        }
+
+        uint64_t lo;
+        std::memcpy(&lo, src, sizeof(lo)); // little-endian (x86/ARM)
+        uint64_t value = lo >> shift;
+        if (shift != 0) {
+            value |= static_cast<uint64_t>(src[8]) << (64 - shift);
         }
-        int byte_index = bit_position / 8;
-        int bit_in_byte = bit_position % 8;
-        if (byte_index >= bytes.size()) {
-            return false;
+        if (count < 64) {
+            value &= (static_cast<uint64_t>(1) << count) - 1;
         }
-        return (bytes[byte_index] >> bit_in_byte) & 1;
+        return value;
     }
 
-    void flip_bit(std::vector<uint8_t>& bytes, int bit_position) {
-        if (bit_position < 0) {
-            return;
+    // XOR         .
+    //          ,
+    //         64 .
+    uint64_t position_syndrome(const uint8_t* bytes, size_t size, bool& data_parity) {
+        size_t data_bits_count = size * 8;
+        uint64_t folded = 0;     // XOR   ( 6  )
+        uint64_t window_xor = 0; // XOR      
+
+        //  m:  (2^m, 2^(m+1)),  =    + m + 2
+        for (unsigned m = 1; ; ++m) {
+            size_t k_begin = (static_cast<size_t>(1) << m) - m - 1;
+            if (k_begin >= data_bits_count) {
+                break;
+            }
+            size_t k_end = std::min(data_bits_count, k_begin + (static_cast<size_t>(1) << m) - 1);
+            size_t offset = m + 2;
+
+            size_t pos = k_begin + offset;
+            size_t pos_end = k_end + offset;
+            while (pos < pos_end) {
+                size_t base = pos & ~static_cast<size_t>(63);
+                unsigned lo = static_cast<unsigned>(pos - base);
+                unsigned count = static_cast<unsigned>(std::min<size_t>(64 - lo, pos_end - pos));
+
+                uint64_t v = load_bits(bytes, size, pos - offset, count) << lo;
+                folded ^= v;
+                if (std::popcount(v) & 1) {
+                    window_xor ^= base;
+                }
+                pos += count;
+            }
+        }
+
+        uint64_t low = 0;
+        for (int t = 0; t < 6; ++t) {
+            if (std::popcount(folded & INDEX_BIT_MASKS[t]) & 1) {
+                low |= static_cast<uint64_t>(1) << t;
+            }
         }
-        int byte_index = bit_position / 8;
-        int bit_in_byte = bit_position % 8;
-        if (byte_index >= bytes.size()) {
-            return;
+
+        data_parity = (std::popcount(folded) & 1) != 0;
+        return window_xor ^ low;
+    }
+
+    // p         p
+    uint64_t compute_check_bits(const uint8_t* bytes, size_t size, int p) {
+        bool data_parity = false;
+        uint64_t syndrome = position_syndrome(bytes, size, data_parity);
+        bool overall_parity = data_parity ^ ((std::popcount(syndrome) & 1) != 0);
+        return syndrome | (static_cast<uint64_t>(overall_parity) << p);
+    }
+
+    uint64_t read_check_bits(std::span<const uint8_t> fcs) {
+        uint64_t value = 0;
+        size_t n = std::min<size_t>(fcs.size(), 8);
+        for (size_t i = 0; i < n; ++i) {
+            value |= static_cast<uint64_t>(fcs[i]) << (i * 8);
         }
-        bytes[byte_index] ^= (1 << bit_in_byte);
+        return value;
     }
 
     //  ,  ,     
-    bool is_power_of_two(int n) {
-        return (n > 0) && ((n & (n - 1)) == 0);
+    bool is_power_of_two(uint64_t n) {
+        return std::has_single_bit(n);
     }
-}
 
-namespace HammingBlock {
-
-    // ---    ---
-    std::vector<uint8_t> generate_fcs(const std::vector<uint8_t>& data) {
-        int data_bits_count = data.size() * 8;
+    //       
+    HammingStatus classify(std::span<const uint8_t> data, std::span<const uint8_t> fcs, uint64_t& syndrome) {
+        size_t data_bits_count = data.size() * 8;
         if (data_bits_count == 0) {
-            return {};
+            return HammingStatus::Clean;
         }
 
-        int p = 0; //    
-        while ((1 << p) < (data_bits_count + p + 1)) {
-            p++;
+        int p = parity_bit_count(data_bits_count);
+
+        if (fcs.size() * 8 < static_cast<size_t>(p) + 1) {
+            return HammingStatus::DoubleDetected;
         }
 
-        std::vector<bool> parity_bits(p, false);
+        // 1. : XOR     
+        uint64_t mask = (static_cast<uint64_t>(1) << p) - 1;
+        uint64_t diff = read_check_bits(fcs) ^ compute_check_bits(data.data(), data.size(), p);
+        syndrome = diff & mask;
+        //    :    
+        //   ,     
+        bool parity_match = (((diff >> p) & 1) ^ (std::popcount(syndrome) & 1)) == 0;
 
-        // 1.    
-        int data_bit_idx = 0;
-        for (int i = 1; i <= data_bits_count + p; ++i) {
-            if (is_power_of_two(i)) {
-                continue; //     
-            }
+        // 2.  
+        if (syndrome == 0) {
+            //        
+            return parity_match ? HammingStatus::Clean : HammingStatus::SingleCorrected;
+        }
+        //    
+        return parity_match ? HammingStatus::DoubleDetected : HammingStatus::SingleCorrected;
+    }
+
+    // ---   (72,64) ---
+    //
+    //   64     : 7   ( 1, 2, 4, ..., 64)
+    //       .      3..71.
+    //  ,     XOR      .
+    const uint8_t NOT_DATA = 0xFF;
+    const size_t WORD_BYTES = 8;
+    const size_t GROUP_BYTES = HammingBlock::FEC_GROUP_BYTES; //  : 8 -
+
+    struct WordTables {
+        uint8_t check[8][256]{};    //   i    v
+        uint8_t dataBit[128]{};     //  ->     NOT_DATA
+    };
 
-            if (get_bit(data, data_bit_idx)) {
-                for (int j = 0; j < p; ++j) {
-                    if ((i >> j) & 1) {
-                        parity_bits[j] = !parity_bits[j];
+    constexpr WordTables make_word_tables() {
+        WordTables t;
+        uint8_t position[64]{};
+        unsigned d = 0;
+        for (unsigned pos = 0; pos < 128; ++pos) {
+            t.dataBit[pos] = NOT_DATA;
+            if (pos > 0 && d < 64 && !std::has_single_bit(pos)) {
+                position[d] = static_cast<uint8_t>(pos);
+                t.dataBit[pos] = static_cast<uint8_t>(d++);
+            }
+        }
+        for (unsigned i = 0; i < 8; ++i) {
+            for (unsigned v = 0; v < 256; ++v) {
+                unsigned syndrome = 0;
+                unsigned parity = 0;
+                for (unsigned b = 0; b < 8; ++b) {
+                    if ((v >> b) & 1) {
+                        syndrome ^= position[i * 8 + b];
+                        parity ^= 1;
                     }
                 }
+                parity ^= std::popcount(syndrome) & 1;
+                t.check[i][v] = static_cast<uint8_t>(syndrome | (parity << 7));
             }
-            data_bit_idx++;
         }
+        return t;
+    }
 
-        // 2.     ( SECDED)
-        bool overall_parity = false;
-        for (int i = 0; i < data_bits_count; ++i) {
-            if (get_bit(data, i)) {
-                overall_parity = !overall_parity;
-            }
+    constexpr WordTables WORD_TABLES = make_word_tables();
+
+    uint8_t word_check(uint64_t word) {
+        uint8_t c = 0;
+        for (unsigned i = 0; i < 8; ++i) {
+            c ^= WORD_TABLES.check[i][(word >> (i * 8)) & 0xFF];
+        }
+        return c;
+    }
+
+    HammingStatus worse(HammingStatus a, HammingStatus b) {
+        return a > b ? a : b;
+    }
+
+    // diff  XOR      ;
+    // bit        NOT_DATA
+    HammingStatus classify_word(uint8_t diff, uint8_t& bit) {
+        bit = NOT_DATA;
+        if (diff == 0) {
+            return HammingStatus::Clean;
+        }
+        uint8_t syndrome = diff & 0x7F;
+        bool parity_match = (((diff >> 7) & 1) ^ (std::popcount(syndrome) & 1)) == 0;
+        if (parity_match) {
+            return HammingStatus::DoubleDetected;
+        }
+        //    :  
+        if (syndrome == 0 || is_power_of_two(syndrome)) {
+            return HammingStatus::SingleCorrected;
         }
-        for (int i = 0; i < p; ++i) {
-            if (parity_bits[i]) {
-                overall_parity = !overall_parity;
+        //        
+        bit = WORD_TABLES.dataBit[syndrome];
+        return bit == NOT_DATA ? HammingStatus::DoubleDetected : HammingStatus::SingleCorrected;
+    }
+
+    uint64_t load_word(const uint8_t* bytes, size_t len) {
+        uint64_t word = 0;
+        if (len >= WORD_BYTES) {
+            std::memcpy(&word, bytes, WORD_BYTES); // little-endian (x86/ARM)
+        }
+        else {
+            std::memcpy(&word, bytes, len);
+        }
+        return word;
+    }
+
+    //   8x8 :  j  i <->  i  j
+    uint64_t transpose8(uint64_t x) {
+        uint64_t t;
+        t = (x ^ (x >> 7)) & 0x00AA00AA00AA00AAull;
+        x ^= t ^ (t << 7);
+        t = (x ^ (x >> 14)) & 0x0000CCCC0000CCCCull;
+        x ^= t ^ (t << 14);
+        t = (x ^ (x >> 28)) & 0x00000000F0F0F0F0ull;
+        x ^= t ^ (t << 28);
+        return x;
+    }
+
+    // :  m    m   ,    
+    //   8        .
+    //  k  m   m    k,
+    //          .
+    //  m      m
+    uint64_t group_checks(const uint8_t* bytes, size_t len) {
+        uint8_t block[GROUP_BYTES];
+        if (len < GROUP_BYTES) {
+            std::memset(block, 0, sizeof(block));
+            std::memcpy(block, bytes, len);
+            bytes = block;
+        }
+        uint8_t checks[8] = {};
+        for (unsigned k = 0; k < 8; ++k) {
+            uint64_t x = transpose8(load_word(bytes + k * WORD_BYTES, WORD_BYTES));
+            for (unsigned m = 0; m < 8; ++m) {
+                checks[m] ^= WORD_TABLES.check[k][(x >> (m * 8)) & 0xFF];
             }
         }
+        uint64_t packed;
+        std::memcpy(&packed, checks, sizeof(packed));
+        return packed;
+    }
 
-        // 3.  p    1      FCS
-        size_t fcs_total_bits = p + 1;
-        std::vector<uint8_t> fcs((fcs_total_bits + 7) / 8, 0);
-        int fcs_bit_idx = 0;
-        for (int i = 0; i < p; ++i) {
-            if (parity_bits[i]) {
-                fcs[fcs_bit_idx / 8] |= (1 << (fcs_bit_idx % 8));
+    size_t blocked_fcs_size(size_t data_len, FecMode mode) {
+        if (mode == FecMode::Blocked) {
+            return (data_len + WORD_BYTES - 1) / WORD_BYTES;
+        }
+        return (data_len + GROUP_BYTES - 1) / GROUP_BYTES * 8;
+    }
+
+    void generate_blocked(std::span<const uint8_t> data, uint8_t* fcs) {
+        for (size_t i = 0; i < data.size(); i += WORD_BYTES) {
+            *fcs++ = word_check(load_word(data.data() + i, data.size() - i));
+        }
+    }
+
+    //     :   FCS 
+    //      
+    void generate_interleaved(std::span<const uint8_t> data, uint8_t* fcs) {
+        for (size_t g = 0; g < data.size(); g += GROUP_BYTES) {
+            uint64_t checks = transpose8(group_checks(data.data() + g, std::min(GROUP_BYTES, data.size() - g)));
+            std::memcpy(fcs, &checks, sizeof(checks));
+            fcs += sizeof(checks);
+        }
+    }
+
+    //     fix (  ) ,  fix == nullptr,  
+    HammingStatus decode_blocked(std::span<const uint8_t> data, std::span<const uint8_t> fcs, uint8_t* fix) {
+        HammingStatus status = HammingStatus::Clean;
+        for (size_t i = 0, w = 0; i < data.size(); i += WORD_BYTES, ++w) {
+            size_t len = std::min(WORD_BYTES, data.size() - i);
+            uint8_t diff = fcs[w] ^ word_check(load_word(data.data() + i, len));
+            if (diff == 0) {
+                continue;
+            }
+            uint8_t bit;
+            HammingStatus s = classify_word(diff, bit);
+            if (bit != NOT_DATA) {
+                if (bit / 8 >= len) {
+                    s = HammingStatus::DoubleDetected; //    
+                }
+                else if (fix) {
+                    fix[i + bit / 8] ^= static_cast<uint8_t>(1 << (bit % 8));
+                }
             }
-            fcs_bit_idx++;
+            status = worse(status, s);
         }
-        if (overall_parity) {
-            fcs[fcs_bit_idx / 8] |= (1 << (fcs_bit_idx % 8));
+        return status;
+    }
+
+    HammingStatus decode_interleaved(std::span<const uint8_t> data, std::span<const uint8_t> fcs, uint8_t* fix) {
+        HammingStatus status = HammingStatus::Clean;
+        for (size_t g = 0; g < data.size(); g += GROUP_BYTES) {
+            size_t len = std::min(GROUP_BYTES, data.size() - g);
+            uint64_t received;
+            std::memcpy(&received, fcs.data() + g / GROUP_BYTES * 8, sizeof(received));
+            uint64_t diffs = transpose8(received) ^ group_checks(data.data() + g, len);
+            if (diffs == 0) {
+                continue;
+            }
+
+            for (unsigned m = 0; m < 8; ++m) {
+                uint8_t bit;
+                HammingStatus s = classify_word(static_cast<uint8_t>(diffs >> (m * 8)), bit);
+                //  e  m   m  e 
+                if (bit != NOT_DATA) {
+                    if (bit >= len) {
+                        s = HammingStatus::DoubleDetected;
+                    }
+                    else if (fix) {
+                        fix[g + bit] ^= static_cast<uint8_t>(1 << m);
+                    }
+                }
+                status = worse(status, s);
+            }
         }
+        return status;
+    }
 
-        return fcs;
+    HammingStatus decode(std::span<const uint8_t> data, std::span<const uint8_t> fcs, FecMode mode, uint8_t* fix) {
+        if (fcs.size() < blocked_fcs_size(data.size(), mode)) {
+            return HammingStatus::DoubleDetected;
+        }
+        return mode == FecMode::Blocked ? decode_blocked(data, fcs, fix) : decode_interleaved(data, fcs, fix);
     }
+}
 
+namespace HammingBlock {
 
-    // ---    ---
-    HammingBlockResult decode_and_correct(const std::vector<uint8_t>& received_data, const std::vector<uint8_t>& received_fcs) {
-        HammingBlockResult result;
-        result.corrected_data = received_data;
-        result.single_error_corrected = false;
-        result.double_error_detected = false;
+    size_t fcs_size(size_t data_len, FecMode mode) {
+        if (mode != FecMode::Whole) {
+            return blocked_fcs_size(data_len, mode);
+        }
+        if (data_len == 0) {
+            return 0;
+        }
+        int p = parity_bit_count(data_len * 8);
+        return (static_cast<size_t>(p) + 1 + 7) / 8;
+    }
 
-        int data_bits_count = received_data.size() * 8;
-        if (data_bits_count == 0) {
-            return result;
+    // ---    ---
+    size_t generate_fcs_into(std::span<const uint8_t> data, std::span<uint8_t> fcs_out, FecMode mode) {
+        if (mode == FecMode::Blocked) {
+            generate_blocked(data, fcs_out.data());
+            return blocked_fcs_size(data.size(), mode);
+        }
+        if (mode == FecMode::Interleaved) {
+            generate_interleaved(data, fcs_out.data());
+            return blocked_fcs_size(data.size(), mode);
         }
 
-        int p = 0;
-        while ((1 << p) < (data_bits_count + p + 1)) {
-            p++;
+        size_t data_bits_count = data.size() * 8;
+        if (data_bits_count == 0) {
+            return 0;
         }
 
-        if (received_fcs.size() * 8 < p + 1) {
-            result.double_error_detected = true;
-            return result;
+        int p = parity_bit_count(data_bits_count); //    
+        uint64_t check_bits = compute_check_bits(data.data(), data.size(), p);
+
+        //  p    1     FCS
+        size_t size = fcs_size(data.size());
+        for (size_t i = 0; i < size; ++i) {
+            fcs_out[i] = static_cast<uint8_t>(check_bits >> (i * 8));
         }
+        return size;
+    }
+
+    std::vector<uint8_t> generate_fcs(const std::vector<uint8_t>& data) {
+        std::vector<uint8_t> fcs(fcs_size(data.size()), 0);
+        generate_fcs_into(data, fcs);
+        return fcs;
+    }
 
-        // 1.  FCS    
-        std::vector<uint8_t> recalculated_fcs_vec = generate_fcs(received_data);
 
-        // 2.   (XOR    FCS)
-        int syndrome = 0;
-        for (int i = 0; i < p; ++i) {
-            if (get_bit(received_fcs, i) != get_bit(recalculated_fcs_vec, i)) {
-                syndrome |= (1 << i);
-            }
+    // ---    ---
+    HammingStatus check(std::span<const uint8_t> data, std::span<const uint8_t> fcs, FecMode mode) {
+        if (mode != FecMode::Whole) {
+            return decode(data, fcs, mode, nullptr);
         }
+        uint64_t syndrome = 0;
+        return classify(data, fcs, syndrome);
+    }
 
-        // 3.   
-        bool received_overall_parity = get_bit(received_fcs, p);
-        bool recalculated_overall_parity = get_bit(recalculated_fcs_vec, p);
-        bool parity_match = (received_overall_parity == recalculated_overall_parity);
+    HammingStatus correct_in_place(std::span<uint8_t> data, std::span<const uint8_t> fcs, FecMode mode) {
+        if (mode != FecMode::Whole) {
+            return decode(data, fcs, mode, data.data());
+        }
+        uint64_t syndrome = 0;
+        HammingStatus status = classify(data, fcs, syndrome);
 
-        // 4.  
-        if (syndrome == 0) {
-            if (!parity_match) {
-                result.single_error_corrected = true; //     
+        //    :   syndrome  bit_width(syndrome)  .
+        //     ,   
+        if (status == HammingStatus::SingleCorrected && syndrome != 0 && !is_power_of_two(syndrome)) {
+            uint64_t data_bit = syndrome - std::bit_width(syndrome) - 1;
+            if (data_bit < data.size() * 8) {
+                data[data_bit / 8] ^= static_cast<uint8_t>(1 << (data_bit % 8));
             }
-            // else:  
         }
-        else {
-            if (!parity_match) {
-                //  
-                result.single_error_corrected = true;
-                int error_pos = syndrome;
-
-                if (!is_power_of_two(error_pos)) {
-                    //    ,   
-                    int data_bit_to_flip = -1;
-                    int current_data_idx = 0;
-                    for (int i = 1; i < error_pos; ++i) {
-                        if (!is_power_of_two(i)) {
-                            current_data_idx++;
-                        }
-                    }
-                    data_bit_to_flip = current_data_idx;
+        return status;
+    }
 
-                    flip_bit(result.corrected_data, data_bit_to_flip);
-                }
-                //     ,   
-            }
-            else {
-                //  
-                result.double_error_detected = true;
+    size_t decode_batch(std::span<const HammingFrameRef> frames, std::span<HammingStatus> statuses) {
+        size_t uncorrectable = 0;
+        for (size_t i = 0; i < frames.size(); ++i) {
+            statuses[i] = correct_in_place(frames[i].data, frames[i].fcs, frames[i].mode);
+            if (statuses[i] == HammingStatus::DoubleDetected) {
+                uncorrectable++;
             }
         }
+        return uncorrectable;
+    }
+
+    HammingBlockResult decode_and_correct(const std::vector<uint8_t>& received_data, const std::vector<uint8_t>& received_fcs) {
+        HammingBlockResult result;
+        result.corrected_data = received_data;
 
+        HammingStatus status = correct_in_place(result.corrected_data, received_fcs);
+        result.single_error_corrected = (status == HammingStatus::SingleCorrected);
+        result.double_error_detected = (status == HammingStatus::DoubleDetected);
         return result;
     }
 
+    bool parse_mode(const std::string& text, FecMode& out) {
+        for (FecMode mode : { FecMode::Whole, FecMode::Blocked, FecMode::Interleaved }) {
+            if (text == mode_name(mode)) {
+                out = mode;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    const char* mode_name(FecMode mode) {
+        switch (mode) {
+        case FecMode::Blocked: return "blocked";
+        case FecMode::Interleaved: return "interleaved";
+        default: return "whole";
+        }
+    }
+
 } // namespace HammingBlock
\ No newline at end of file
@@ -1,6 +1,9 @@
 #pragma once
 #include <vector>
+#include <string>
+#include <span>
 #include <cstdint>
+#include <cstddef>
 
 //    
 struct HammingBlockResult {
@@ -9,13 +12,59 @@ struct HammingBlockResult {
     bool double_error_detected;
 };
 
+//     
+enum class HammingStatus : uint8_t {
+    Clean,
+    SingleCorrected,
+    DoubleDetected
+};
+
+//  FCS   
+enum class FecMode : uint8_t {
+    Whole,          //     :     
+    Blocked,        //  (72,64)   8  
+    Interleaved     // (72,64)      64 :   8  
+};
+
+//   FCS     
+struct HammingFrameRef {
+    std::span<uint8_t> data;
+    std::span<const uint8_t> fcs;
+    FecMode mode = FecMode::Whole;
+};
+
 namespace HammingBlock {
+    //    FCS        8 
+    //     :     
+    const size_t FEC_GROUP_BYTES = 64;
+
+    //  FCS       data_len.
+    size_t fcs_size(size_t data_len, FecMode mode = FecMode::Whole);
+
     //  FCS    .
     std::vector<uint8_t> generate_fcs(const std::vector<uint8_t>& data);
 
+    //  FCS  fcs_out (  fcs_size(data.size()) ),   .
+    size_t generate_fcs_into(std::span<const uint8_t> data, std::span<uint8_t> fcs_out, FecMode mode = FecMode::Whole);
+
+    //    ,   .
+    //          .
+    HammingStatus check(std::span<const uint8_t> data, std::span<const uint8_t> fcs, FecMode mode = FecMode::Whole);
+
+    //    ,   .
+    HammingStatus correct_in_place(std::span<uint8_t> data, std::span<const uint8_t> fcs, FecMode mode = FecMode::Whole);
+
+    //     , statuses[i]    frames[i].
+    //      .
+    size_t decode_batch(std::span<const HammingFrameRef> frames, std::span<HammingStatus> statuses);
+
     //    ,   FCS.
     HammingBlockResult decode_and_correct(
         const std::vector<uint8_t>& received_data,
         const std::vector<uint8_t>& received_fcs
     );
+
+    // whole, blocked, interleaved
+    bool parse_mode(const std::string& text, FecMode& out);
+    const char* mode_name(FecMode mode);
 }
\ No newline at end of file
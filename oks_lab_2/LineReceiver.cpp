@@ -0,0 +1,92 @@
+﻿#include "LineReceiver.h"
+#include <algorithm>
+#include <cstdint>
+
+LineReceiver::LineReceiver(const CSMA::Params& params, uint32_t seed) :
+    params(params),
+    rng(seed) {
+    cleanBytes = nextCollisionGap();
+}
+
+void LineReceiver::setFrameHandler(FrameParser::FrameHandler onFrame) {
+    parser.setHandler(std::move(onFrame));
+}
+
+void LineReceiver::setReply(Reply replyFn) {
+    reply = std::move(replyFn);
+}
+
+void LineReceiver::setEventHandler(EventHandler handler) {
+    onEvent = std::move(handler);
+}
+
+void LineReceiver::notify(Event event) {
+    if (onEvent) onEvent(event);
+}
+
+void LineReceiver::reset() {
+    parser.reset();
+    jamSequenceActive = false;
+}
+
+// Число байтов без коллизии до следующей: геометрическое распределение
+// с вероятностью probCollision, как у независимого броска на каждый байт
+size_t LineReceiver::nextCollisionGap() {
+    double p = params.probCollision;
+    if (p <= 0.0) return SIZE_MAX;
+    if (p >= 1.0) return 0;
+    return std::geometric_distribution<size_t>(p)(rng);
+}
+
+void LineReceiver::feed(std::span<const uint8_t> bytes) {
+    size_t i = 0;
+    while (i < bytes.size()) {
+        // Внутри тела кадра управляющих байтов нет: участок до следующей
+        // коллизии уходит разборщику целиком
+        size_t run = std::min({ parser.bodyBytesLeft(), bytes.size() - i, cleanBytes });
+        if (run > 0) {
+            parser.feed(bytes.subspan(i, run));
+            cleanBytes -= run;
+            jamSequenceActive = false;
+            i += run;
+            continue;
+        }
+
+        uint8_t byte = bytes[i++];
+        // Внутри полей кадра управляющих байтов нет
+        bool controlAllowed = !parser.collectingFields();
+
+        if (controlAllowed && byte == CSMA::ENQ) {
+            if (dist(rng) < params.probChannelBusy) {
+                notify(Event::ChannelBusy);
+            }
+            else if (reply) {
+                reply(CSMA::ACK);
+            }
+            jamSequenceActive = false;
+            continue;
+        }
+
+        if (controlAllowed && byte == CSMA::JAM) {
+            if (!jamSequenceActive) {
+                notify(Event::Jam);
+                jamSequenceActive = true;
+            }
+            parser.reset();
+            continue;
+        }
+
+        jamSequenceActive = false;
+
+        if (cleanBytes == 0) {
+            cleanBytes = nextCollisionGap();
+            notify(Event::Collision);
+            if (reply) reply(CSMA::COL);
+            parser.reset();
+            continue;
+        }
+
+        cleanBytes--;
+        parser.push(byte);
+    }
+}
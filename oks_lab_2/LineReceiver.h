@@ -0,0 +1,50 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <random>
+#include <span>
+#include "CsmaConfig.h"
+#include "FrameParser.h"
+
+//    CSMA/CD:   ENQ (  ),
+//    JAM,     .
+//   :    reply,     .
+class LineReceiver {
+public:
+    enum class Event {
+        ChannelBusy, // ENQ   
+        Jam,         //  JAM-
+        Collision    //  ,    COL
+    };
+
+    using Reply = std::function<void(uint8_t)>;
+    using EventHandler = std::function<void(Event)>;
+
+    LineReceiver(const CSMA::Params& params, uint32_t seed);
+
+    void setFrameHandler(FrameParser::FrameHandler onFrame);
+    void setReply(Reply reply);
+    void setEventHandler(EventHandler onEvent);
+
+    //     
+    void feed(std::span<const uint8_t> bytes);
+
+    void reset();
+
+private:
+    CSMA::Params params;
+    std::mt19937 rng;
+    std::uniform_real_distribution<double> dist{ 0.0, 1.0 };
+    //     .  -
+    //       probCollision,  
+    //    ,      
+    size_t cleanBytes = 0;
+
+    FrameParser parser;
+    Reply reply;
+    EventHandler onEvent;
+    bool jamSequenceActive = false;
+
+    void notify(Event event);
+    size_t nextCollisionGap();
+};
@@ -0,0 +1,296 @@
+﻿#include "LinkManager.h"
+
+#ifdef __linux__
+#include <algorithm>
+#include <chrono>
+#include "HammingBlock.h"
+#include "Trace.h"
+#include "Transport.h"
+
+namespace {
+    // Сообщение, которое кодируют несколько задач пула
+    struct EncodeJob {
+        std::string message;
+        std::vector<std::vector<uint8_t>> frames;
+        std::atomic<size_t> remaining{ 0 };
+        std::function<void(bool)> done;
+        uint64_t ticket = 0;
+        uint32_t seqBase = 0;
+    };
+}
+
+LinkManager::LinkManager(const Config& cfg) :
+    config(cfg),
+    pool(cfg.workers) {
+}
+
+LinkManager::~LinkManager() {
+    stop();
+    pool.wait();
+    links.clear();
+}
+
+// Реакторы создаются по мере добавления линий, дальше линии делятся по кругу
+Reactor& LinkManager::reactorFor(size_t index) {
+    unsigned limit = config.reactors != 0 ? config.reactors : std::max(1u, std::thread::hardware_concurrency());
+    if (reactors.size() < limit) {
+        reactors.push_back(std::make_unique<Reactor>());
+        return *reactors.back();
+    }
+    return *reactors[index % reactors.size()];
+}
+
+int LinkManager::addLink(const std::string& sendPort, const std::string& receivePort) {
+    if (running) return -1;
+
+    auto link = std::make_unique<Link>();
+    link->sendPort = sendPort;
+    link->receivePort = receivePort;
+    link->reactor = &reactorFor(links.size());
+    if (!link->reactor->valid()) return -1;
+
+    link->async = std::make_unique<AsyncLink>(*link->reactor, config.params,
+        static_cast<uint32_t>(config.seed + links.size()));
+    if (!link->async->open(sendPort, receivePort, config.baudRate)) return -1;
+    link->async->setNoise(config.noise);
+    link->traceChannel = Transport::portNumber(sendPort);
+
+    Link* raw = link.get();
+    link->async->setRawFrameHandler([this, raw](Frame& frame) { onFrame(*raw, frame); });
+
+    links.push_back(std::move(link));
+    return static_cast<int>(links.size() - 1);
+}
+
+void LinkManager::start() {
+    if (running) return;
+    running = true;
+    for (auto& reactor : reactors) {
+        reactorThreads.emplace_back([r = reactor.get()] { r->run(); });
+    }
+}
+
+void LinkManager::stop() {
+    if (!running) return;
+    for (auto& reactor : reactors) {
+        reactor->stop();
+    }
+    for (std::thread& t : reactorThreads) {
+        t.join();
+    }
+    reactorThreads.clear();
+    running = false;
+}
+
+// --- ОТПРАВКА ---
+
+void LinkManager::send(int index, std::string message, std::function<void(bool)> done) {
+    Link& link = *links[index];
+
+    auto job = std::make_shared<EncodeJob>();
+    size_t payload = std::max<size_t>(1, config.payloadSize);
+    size_t frameCount = (message.size() + payload - 1) / payload;
+
+    job->message = std::move(message);
+    job->frames.resize(frameCount);
+    job->done = std::move(done);
+    job->ticket = link.nextTicket++;
+    job->seqBase = link.nextSeq.fetch_add(static_cast<uint32_t>(frameCount));
+
+    outstanding++;
+    {
+        std::lock_guard<std::mutex> lock(link.timeMutex);
+        if (!link.started) {
+            link.started = true;
+            link.firstSend = Clock::now();
+        }
+    }
+
+    if (frameCount == 0) {
+        link.reactor->post([this, &link, job] {
+            link.ready[job->ticket] = Encoded{ {}, std::move(job->done) };
+            releaseReady(link);
+        });
+        return;
+    }
+
+    // Кадры кодируются порциями параллельно: последняя задача отдает сообщение реактору
+    size_t tasks = (frameCount + FRAMES_PER_TASK - 1) / FRAMES_PER_TASK;
+    job->remaining = tasks;
+    for (size_t t = 0; t < tasks; ++t) {
+        pool.submit([this, &link, job, t, payload] {
+            Frame frame;
+            frame.sender = Transport::portNumber(link.sendPort);
+            frame.receiver = Transport::portNumber(link.receivePort);
+            frame.timestamp = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count());
+            frame.setFecMode(config.fec);
+            frame.setCrc(config.crc);
+            frame.setCompactHeader(config.compactHeader);
+            // Порции кодируются независимо: у каждой свои опорные записи
+            CompactHeader::Encoder headers(static_cast<uint8_t>(
+                link.headerContext.fetch_add(CONTEXTS_PER_TASK, std::memory_order_relaxed)));
+
+            size_t first = t * FRAMES_PER_TASK;
+            size_t last = std::min(job->frames.size(), first + FRAMES_PER_TASK);
+            for (size_t i = first; i < last; ++i) {
+                size_t offset = i * payload;
+                size_t len = std::min(payload, job->message.size() - offset);
+                frame.seqNumber = static_cast<uint8_t>(job->seqBase + i);
+                frame.dataLen = static_cast<uint16_t>(len);
+                frame.data.assign(std::span<const uint8_t>(
+                    reinterpret_cast<const uint8_t*>(job->message.data()) + offset, len));
+
+                std::vector<uint8_t>& raw = job->frames[i];
+                raw.resize(Frame::max_encoded_size(len));
+                raw.resize(frame.encode_into(raw, &headers));
+            }
+
+            if (--job->remaining == 0) {
+                link.reactor->post([this, &link, job] {
+                    link.ready[job->ticket] = Encoded{ std::move(job->frames), std::move(job->done) };
+                    releaseReady(link);
+                });
+            }
+        });
+    }
+}
+
+// Поток реактора: сообщения уходят в линию в порядке постановки
+void LinkManager::releaseReady(Link& link) {
+    while (true) {
+        auto it = link.ready.find(link.sendTicket);
+        if (it == link.ready.end()) return;
+
+        auto frameCount = it->second.frames.size();
+        auto done = std::make_shared<std::function<void(bool)>>(std::move(it->second.done));
+        link.async->sendFrames(std::move(it->second.frames), [this, &link, frameCount, done](bool ok) {
+            if (ok) link.framesSent += frameCount;
+            finishMessage(link, ok, *done);
+        });
+        link.ready.erase(it);
+        link.sendTicket++;
+    }
+}
+
+void LinkManager::finishMessage(Link& link, bool ok, const std::function<void(bool)>& done) {
+    if (ok) link.messagesSent++;
+    else link.messagesFailed++;
+    {
+        std::lock_guard<std::mutex> lock(link.timeMutex);
+        link.lastDone = Clock::now();
+    }
+    if (done) done(ok);
+
+    if (--outstanding == 0) {
+        std::lock_guard<std::mutex> lock(idleMutex);
+        idleChanged.notify_all();
+    }
+}
+
+// --- ПРИЕМ ---
+
+// Поток реактора: кадр приходит без проверки FEC, исправление ошибок
+// и его статистика — только в пуле
+void LinkManager::onFrame(Link& link, Frame& frame) {
+    link.framesReceived++;
+    auto received = std::make_shared<Frame>(std::move(frame));
+    pool.submit([&link, received] {
+        HammingStatus status = received->correct_in_place();
+        Trace::emit(Trace::Event::EccResult, link.traceChannel, static_cast<uint32_t>(status));
+        switch (status) {
+        case HammingStatus::DoubleDetected:
+            link.framesUncorrectable++;
+            return;
+        case HammingStatus::SingleCorrected:
+            link.framesCorrected++;
+            break;
+        default:
+            break;
+        }
+        link.payloadBytes += received->data.size();
+    });
+}
+
+void LinkManager::waitIdle() {
+    {
+        std::unique_lock<std::mutex> lock(idleMutex);
+        idleChanged.wait(lock, [this] { return outstanding == 0; });
+    }
+
+    // Два прохода по каждому реактору: байты, записанные последними кадрами,
+    // успевают дойти до приемника и попасть в пул
+    for (int pass = 0; pass < 2 && running; ++pass) {
+        std::mutex barrierMutex;
+        std::condition_variable barrierDone;
+        size_t left = reactors.size();
+        for (auto& reactor : reactors) {
+            reactor->post([&] {
+                std::lock_guard<std::mutex> lock(barrierMutex);
+                if (--left == 0) barrierDone.notify_all();
+            });
+        }
+        std::unique_lock<std::mutex> lock(barrierMutex);
+        barrierDone.wait(lock, [&] { return left == 0; });
+    }
+    pool.wait();
+}
+
+// --- СТАТИСТИКА ---
+
+std::vector<LinkManager::LinkStats> LinkManager::linkStats() const {
+    std::vector<LinkStats> result;
+    for (const auto& link : links) {
+        LinkStats s;
+        s.sendPort = link->sendPort;
+        s.receivePort = link->receivePort;
+        s.messagesSent = link->messagesSent;
+        s.messagesFailed = link->messagesFailed;
+        s.framesSent = link->framesSent;
+        s.framesReceived = link->framesReceived;
+        s.framesCorrected = link->framesCorrected;
+        s.framesUncorrectable = link->framesUncorrectable;
+        s.payloadBytesReceived = link->payloadBytes;
+        s.collisions = link->async->getStats().collisions;
+        {
+            std::lock_guard<std::mutex> lock(link->timeMutex);
+            if (link->started && link->lastDone > link->firstSend) {
+                s.seconds = std::chrono::duration<double>(link->lastDone - link->firstSend).count();
+            }
+        }
+        result.push_back(s);
+    }
+    return result;
+}
+
+// Итог по всем линиям; время — от первой отправки до последнего завершения
+LinkManager::LinkStats LinkManager::totalStats() const {
+    LinkStats total;
+    total.sendPort = "*";
+    total.receivePort = "*";
+
+    bool any = false;
+    Clock::time_point first, last;
+    for (const auto& link : links) {
+        total.messagesSent += link->messagesSent;
+        total.messagesFailed += link->messagesFailed;
+        total.framesSent += link->framesSent;
+        total.framesReceived += link->framesReceived;
+        total.framesCorrected += link->framesCorrected;
+        total.framesUncorrectable += link->framesUncorrectable;
+        total.payloadBytesReceived += link->payloadBytes;
+        total.collisions += link->async->getStats().collisions;
+
+        std::lock_guard<std::mutex> lock(link->timeMutex);
+        if (!link->started) continue;
+        if (!any || link->firstSend < first) first = link->firstSend;
+        if (!any || link->lastDone > last) last = link->lastDone;
+        any = true;
+    }
+    if (any && last > first) {
+        total.seconds = std::chrono::duration<double>(last - first).count();
+    }
+    return total;
+}
+
+#endif
@@ -0,0 +1,139 @@
+#pragma once
+#ifdef __linux__
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "AsyncLink.h"
+#include "ChannelNoise.h"
+#include "CsmaConfig.h"
+#include "PayloadSizer.h"
+#include "Reactor.h"
+#include "WorkStealingPool.h"
+
+//     . -  CSMA/CD  
+//  AsyncLink      (   
+//  ),    , FEC      
+//       WorkStealingPool.
+class LinkManager {
+public:
+    struct Config {
+        unsigned reactors = 0;          // 0    ,     
+        unsigned workers = 0;           // 0    
+        uint32_t baudRate = 115200;
+        size_t payloadSize = PayloadSizer::DEFAULT_PAYLOAD;
+        CSMA::Params params;
+        ChannelNoise::Model noise = ChannelNoise::Model::lab();
+        FecMode fec = FecMode::Whole;
+        bool crc = false;               // CRC-32C  
+        bool compactHeader = false;     //   (CompactHeader)
+        uint64_t seed = 1;
+    };
+
+    struct LinkStats {
+        std::string sendPort;
+        std::string receivePort;
+        uint64_t messagesSent = 0;
+        uint64_t messagesFailed = 0;
+        uint64_t framesSent = 0;
+        uint64_t framesReceived = 0;
+        uint64_t framesCorrected = 0;
+        uint64_t framesUncorrectable = 0;
+        uint64_t payloadBytesReceived = 0;  //     
+        int collisions = 0;
+        double seconds = 0.0;               //      
+
+        double throughput() const { return seconds > 0.0 ? payloadBytesReceived / seconds : 0.0; }
+    };
+
+    explicit LinkManager(const Config& config);
+    ~LinkManager();
+
+    LinkManager(const LinkManager&) = delete;
+    LinkManager& operator=(const LinkManager&) = delete;
+
+    //    start().     -1
+    int addLink(const std::string& sendPort, const std::string& receivePort);
+    size_t linkCount() const { return links.size(); }
+
+    void start();
+    void stop();
+
+    //     .     ;
+    //       
+    void send(int link, std::string message, std::function<void(bool)> done = nullptr);
+
+    //        
+    void waitIdle();
+
+    std::vector<LinkStats> linkStats() const;
+    LinkStats totalStats() const;
+
+    unsigned reactorCount() const { return static_cast<unsigned>(reactors.size()); }
+    unsigned workerCount() const { return pool.size(); }
+    uint64_t stolenTasks() const { return pool.stolenCount(); }
+
+private:
+    using Clock = Timing::Clock;
+
+    //  ,     
+    struct Encoded {
+        std::vector<std::vector<uint8_t>> frames;
+        std::function<void(bool)> done;
+    };
+
+    struct Link {
+        std::string sendPort;
+        std::string receivePort;
+        Reactor* reactor = nullptr;
+        std::unique_ptr<AsyncLink> async;
+        uint16_t traceChannel = 0;              //   ,   AsyncLink
+
+        std::atomic<uint64_t> nextTicket{ 0 };  //    
+        std::atomic<uint32_t> nextSeq{ 0 };     //  
+        std::atomic<uint32_t> headerContext{ 0 }; //    
+        uint64_t sendTicket = 0;                //    ( )
+        std::map<uint64_t, Encoded> ready;      //    ( )
+
+        std::atomic<uint64_t> messagesSent{ 0 };
+        std::atomic<uint64_t> messagesFailed{ 0 };
+        std::atomic<uint64_t> framesSent{ 0 };
+        std::atomic<uint64_t> framesReceived{ 0 };
+        std::atomic<uint64_t> framesCorrected{ 0 };
+        std::atomic<uint64_t> framesUncorrectable{ 0 };
+        std::atomic<uint64_t> payloadBytes{ 0 };
+
+        std::mutex timeMutex;
+        bool started = false;
+        Clock::time_point firstSend;
+        Clock::time_point lastDone;
+    };
+
+    //      
+    static const size_t FRAMES_PER_TASK = 64;
+    //      :     REFRESH_FRAMES 
+    static const size_t CONTEXTS_PER_TASK = (FRAMES_PER_TASK + CompactHeader::REFRESH_FRAMES) / (CompactHeader::REFRESH_FRAMES + 1);
+
+    Config config;
+    WorkStealingPool pool;
+    std::vector<std::unique_ptr<Reactor>> reactors;
+    std::vector<std::thread> reactorThreads;
+    std::vector<std::unique_ptr<Link>> links;
+    bool running = false;
+
+    std::atomic<size_t> outstanding{ 0 };   //   
+    std::mutex idleMutex;
+    std::condition_variable idleChanged;
+
+    Reactor& reactorFor(size_t index);
+    void releaseReady(Link& link);
+    void onFrame(Link& link, Frame& frame);
+    void finishMessage(Link& link, bool ok, const std::function<void(bool)>& done);
+};
+#endif
@@ -0,0 +1,155 @@
+﻿#include "Log.h"
+#include <chrono>
+#include <condition_variable>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include "MpscQueue.h"
+
+namespace Log {
+
+    std::atomic<Level> threshold{ Level::Info };
+
+    namespace {
+        const size_t QUEUE_CAPACITY = 1024;
+        const size_t BATCH_BYTES = 16 * 1024;
+
+        std::atomic<uint64_t> dropped{ 0 };
+
+        // Фоновый вывод. Строки копятся в пакет и пишутся одним write,
+        // сброс потока — только когда очередь опустела
+        class Writer {
+        public:
+            Writer() : thread(&Writer::run, this) {}
+
+            ~Writer() {
+                Message stop;
+                stop.level = Level::Off;   // признак завершения
+                while (!queue.push(std::move(stop))) {
+                    std::this_thread::yield();
+                }
+                thread.join();
+            }
+
+            bool push(Message& message) {
+                if (!queue.push(std::move(message))) return false;
+                submitted.fetch_add(1, std::memory_order_release);
+                return true;
+            }
+
+            void flush() {
+                uint64_t target = submitted.load(std::memory_order_acquire);
+                std::unique_lock<std::mutex> lock(flushMutex);
+                flushed.wait(lock, [this, target] { return written >= target; });
+            }
+
+        private:
+            MpscQueue<Message, QUEUE_CAPACITY> queue;
+            std::atomic<uint64_t> submitted{ 0 };
+            uint64_t written = 0;   // под flushMutex
+            std::mutex flushMutex;
+            std::condition_variable flushed;
+            std::thread thread;
+
+            void run() {
+                std::string batch;
+                Message m;
+                bool stopping = false;
+                while (!stopping) {
+                    uint64_t count = 0;
+                    while (queue.pop(m)) {
+                        if (m.level == Level::Off) {
+                            stopping = true;
+                            break;
+                        }
+                        batch.append(m.text, m.length);
+                        batch.push_back('\n');
+                        ++count;
+                        if (batch.size() >= BATCH_BYTES) {
+                            std::cout.write(batch.data(), batch.size());
+                            batch.clear();
+                        }
+                    }
+                    if (count > 0) {
+                        std::cout.write(batch.data(), batch.size());
+                        std::cout.flush();
+                        batch.clear();
+
+                        std::lock_guard<std::mutex> lock(flushMutex);
+                        written += count;
+                        flushed.notify_all();
+                    }
+                    if (!stopping) queue.waitFor(std::chrono::milliseconds(100));
+                }
+            }
+        };
+
+        Writer& writer() {
+            static Writer instance;
+            return instance;
+        }
+    }
+
+    void setLevel(Level level) {
+        threshold.store(level, std::memory_order_relaxed);
+    }
+
+    Level getLevel() {
+        return threshold.load(std::memory_order_relaxed);
+    }
+
+    bool parse_level(const std::string& text, Level& out) {
+        for (Level level : { Level::Debug, Level::Info, Level::Warning, Level::Error, Level::Off }) {
+            if (text == level_name(level)) {
+                out = level;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    const char* level_name(Level level) {
+        switch (level) {
+        case Level::Debug: return "debug";
+        case Level::Info: return "info";
+        case Level::Warning: return "warning";
+        case Level::Error: return "error";
+        default: return "off";
+        }
+    }
+
+    bool submit(Message& message) {
+        if (writer().push(message)) return true;
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    void flush() {
+        writer().flush();
+    }
+
+    uint64_t droppedCount() {
+        return dropped.load(std::memory_order_relaxed);
+    }
+
+    bool RateLimit::allow() {
+        int64_t now = std::chrono::duration_cast<std::chrono::seconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+        int64_t start = windowStart.load(std::memory_order_relaxed);
+        if (now != start && windowStart.compare_exchange_strong(start, now, std::memory_order_relaxed)) {
+            inWindow.store(0, std::memory_order_relaxed);
+        }
+        if (inWindow.fetch_add(1, std::memory_order_relaxed) < RATE_LIMIT_PER_SECOND) return true;
+        suppressed.fetch_add(1, std::memory_order_relaxed);
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    namespace detail {
+        void note_suppressed(Message& m, uint32_t n) {
+            append(m, "(пропущено строк: ");
+            append(m, n);
+            append(m, ") ");
+        }
+    }
+}
@@ -0,0 +1,117 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+//  .      
+//         ;    
+//  .       
+// .      .
+//  OKS_LOG_DISABLED  LOG_*    .
+namespace Log {
+    enum class Level : uint8_t {
+        Debug,
+        Info,
+        Warning,
+        Error,
+        Off
+    };
+
+    const size_t MAX_MESSAGE = 240;             //   
+    const uint32_t RATE_LIMIT_PER_SECOND = 200; //     
+
+    struct Message {
+        Level level = Level::Info;
+        uint16_t length = 0;
+        char text[MAX_MESSAGE];
+    };
+
+    extern std::atomic<Level> threshold;
+
+    inline bool enabled(Level level) { return level >= threshold.load(std::memory_order_relaxed); }
+    void setLevel(Level level);
+    Level getLevel();
+
+    // debug, info, warning, error, off
+    bool parse_level(const std::string& text, Level& out);
+    const char* level_name(Level level);
+
+    //    ; false   
+    bool submit(Message& message);
+
+    // ,     ,    
+    void flush();
+
+    //   :     
+    uint64_t droppedCount();
+
+    //       .  
+    //      
+    class RateLimit {
+    public:
+        bool allow();
+        uint32_t takeSuppressed() { return suppressed.exchange(0, std::memory_order_relaxed); }
+
+    private:
+        std::atomic<int64_t> windowStart{ 0 };
+        std::atomic<uint32_t> inWindow{ 0 };
+        std::atomic<uint32_t> suppressed{ 0 };
+    };
+
+    namespace detail {
+        inline void append(Message& m, std::string_view s) {
+            size_t n = std::min(s.size(), MAX_MESSAGE - m.length);
+            std::memcpy(m.text + m.length, s.data(), n);
+            m.length = static_cast<uint16_t>(m.length + n);
+        }
+
+        inline void append(Message& m, const char* s) { append(m, std::string_view(s)); }
+        inline void append(Message& m, const std::string& s) { append(m, std::string_view(s)); }
+        inline void append(Message& m, char c) { append(m, std::string_view(&c, 1)); }
+
+        template <typename T>
+        std::enable_if_t<std::is_arithmetic_v<T> && !std::is_same_v<T, bool>> append(Message& m, T value) {
+            char buffer[32];
+            auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+            append(m, std::string_view(buffer, result.ptr - buffer));
+        }
+
+        //       
+        void note_suppressed(Message& m, uint32_t n);
+    }
+
+    template <typename... Args>
+    void write(Level level, RateLimit& limit, const Args&... args) {
+        if (!limit.allow()) return;
+
+        Message m;
+        m.level = level;
+        if (uint32_t skipped = limit.takeSuppressed()) {
+            detail::note_suppressed(m, skipped);
+        }
+        (detail::append(m, args), ...);
+        submit(m);
+    }
+}
+
+#ifdef OKS_LOG_DISABLED
+#define OKS_LOG(level, ...) ((void)0)
+#else
+#define OKS_LOG(level, ...)                                         \
+    do {                                                            \
+        if (::Log::enabled(level)) {                                \
+            static ::Log::RateLimit oksLogLimit;                    \
+            ::Log::write(level, oksLogLimit, __VA_ARGS__);          \
+        }                                                           \
+    } while (0)
+#endif
+
+#define LOG_DEBUG(...) OKS_LOG(::Log::Level::Debug, __VA_ARGS__)
+#define LOG_INFO(...) OKS_LOG(::Log::Level::Info, __VA_ARGS__)
+#define LOG_WARNING(...) OKS_LOG(::Log::Level::Warning, __VA_ARGS__)
+#define LOG_ERROR(...) OKS_LOG(::Log::Level::Error, __VA_ARGS__)
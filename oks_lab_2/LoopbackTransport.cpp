@@ -0,0 +1,211 @@
+﻿#include "LoopbackTransport.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/eventfd.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    const size_t CHANNEL_CAPACITY = 64 * 1024;
+    const int WRITE_TIMEOUT_MS = 100;
+}
+
+// Одно направление петли. head и tail растут монотонно, позиция в кольце — по модулю емкости.
+struct LoopbackTransport::Channel {
+    std::vector<uint8_t> ring = std::vector<uint8_t>(CHANNEL_CAPACITY);
+    size_t head = 0;
+    size_t tail = 0;
+    std::mutex mutex;
+    std::condition_variable dataReady;
+    std::condition_variable spaceReady;
+    bool interrupted = false;
+
+#ifdef __linux__
+    // Ненулевой счетчик, пока в кольце есть данные: порт можно ждать через epoll.
+    // Меняется только под mutex вместе с head/tail
+    int readyFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+    ~Channel() {
+        if (readyFd >= 0) ::close(readyFd);
+    }
+#endif
+
+    void signalData() {
+#ifdef __linux__
+        uint64_t one = 1;
+        [[maybe_unused]] ssize_t n = ::write(readyFd, &one, sizeof(one));
+#endif
+    }
+
+    void clearSignalIfEmpty() {
+#ifdef __linux__
+        uint64_t count;
+        if (head == tail) {
+            [[maybe_unused]] ssize_t n = ::read(readyFd, &count, sizeof(count));
+        }
+#endif
+    }
+
+    // Непрерывный участок готовых данных
+    std::span<const uint8_t> readable() const {
+        size_t offset = head % ring.size();
+        size_t n = std::min(tail - head, ring.size() - offset);
+        return std::span<const uint8_t>(ring.data() + offset, n);
+    }
+
+    // false — срок истек или ожидание прервано
+    bool waitData(std::unique_lock<std::mutex>& lock, Timing::Clock::time_point deadline) {
+        auto ready = [this] { return tail != head || interrupted; };
+        if (deadline == Timing::NO_DEADLINE) dataReady.wait(lock, ready);
+        else dataReady.wait_until(lock, deadline, ready);
+
+        if (interrupted) {
+            interrupted = false;
+            return false;
+        }
+        return tail != head;
+    }
+
+    void consume(size_t n) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            head += n;
+            clearSignalIfEmpty();
+        }
+        spaceReady.notify_one();
+    }
+};
+
+struct LoopbackTransport::Link {
+    Channel aToB;
+    Channel bToA;
+};
+
+std::shared_ptr<LoopbackTransport::Link> LoopbackTransport::acquireLink(const std::string& key) {
+    static std::mutex registryMutex;
+    static std::map<std::string, std::weak_ptr<Link>> registry;
+
+    std::lock_guard<std::mutex> lock(registryMutex);
+    if (auto existing = registry[key].lock()) {
+        return existing;
+    }
+    auto created = std::make_shared<Link>();
+    registry[key] = created;
+    return created;
+}
+
+LoopbackTransport::~LoopbackTransport() {
+    close();
+}
+
+bool LoopbackTransport::open(const std::string& portName, uint32_t) {
+    close();
+    if (portName.size() < 2) return false;
+
+    char end = portName.back();
+    if (end != 'A' && end != 'B') return false;
+
+    link = acquireLink(portName.substr(0, portName.size() - 1));
+    tx = (end == 'A') ? &link->aToB : &link->bToA;
+    rx = (end == 'A') ? &link->bToA : &link->aToB;
+    return true;
+}
+
+void LoopbackTransport::close() {
+    rx = nullptr;
+    tx = nullptr;
+    link.reset();
+}
+
+bool LoopbackTransport::isOpen() const {
+    return link != nullptr;
+}
+
+// Петля работает со скоростью памяти, скорость линии не моделируется
+bool LoopbackTransport::setBaudRate(uint32_t) {
+    return true;
+}
+
+size_t LoopbackTransport::write(std::span<const uint8_t> data) {
+    size_t written = 0;
+    {
+        std::unique_lock<std::mutex> lock(tx->mutex);
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(WRITE_TIMEOUT_MS);
+        while (written < data.size()) {
+            size_t capacity = tx->ring.size();
+            if (!tx->spaceReady.wait_until(lock, deadline, [&] { return tx->tail - tx->head < capacity; })) {
+                break; // читатель не забирает данные
+            }
+            size_t offset = tx->tail % capacity;
+            size_t n = std::min({ data.size() - written, capacity - (tx->tail - tx->head), capacity - offset });
+            std::memcpy(tx->ring.data() + offset, data.data() + written, n);
+            tx->tail += n;
+            written += n;
+            tx->signalData();
+            tx->dataReady.notify_one();
+        }
+    }
+    return written;
+}
+
+size_t LoopbackTransport::readUntil(std::span<uint8_t> buffer, Timing::Clock::time_point deadline) {
+    size_t total = 0;
+    while (total < buffer.size()) {
+        std::span<const uint8_t> chunk;
+        {
+            std::unique_lock<std::mutex> lock(rx->mutex);
+            if (total == 0 ? !rx->waitData(lock, deadline) : rx->tail == rx->head) break;
+            chunk = rx->readable();
+        }
+        size_t n = std::min(chunk.size(), buffer.size() - total);
+        std::memcpy(buffer.data() + total, chunk.data(), n);
+        rx->consume(n);
+        total += n;
+    }
+    return total;
+}
+
+size_t LoopbackTransport::receiveUntil(const ReceiveSink& sink, Timing::Clock::time_point deadline) {
+    std::span<const uint8_t> chunk;
+    {
+        std::unique_lock<std::mutex> lock(rx->mutex);
+        if (!rx->waitData(lock, deadline)) return 0;
+        chunk = rx->readable();
+    }
+    // Писатель не трогает занятую часть кольца, пока читатель не сдвинет head
+    sink(chunk);
+    rx->consume(chunk.size());
+    return chunk.size();
+}
+
+void LoopbackTransport::interrupt() {
+    {
+        std::lock_guard<std::mutex> lock(rx->mutex);
+        rx->interrupted = true;
+    }
+    rx->dataReady.notify_all();
+}
+
+int LoopbackTransport::readinessHandle() const {
+#ifdef __linux__
+    return rx ? rx->readyFd : -1;
+#else
+    return -1;
+#endif
+}
+
+void LoopbackTransport::purgeInput() {
+    {
+        std::lock_guard<std::mutex> lock(rx->mutex);
+        rx->head = rx->tail;
+        rx->clearSignalIfEmpty();
+    }
+    rx->spaceReady.notify_one();
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include <memory>
+#include "Transport.h"
+
+//   : LOOP<n>A  LOOP<n>B    ,  -.
+//           ;
+// receive()     ,   .
+class LoopbackTransport : public Transport {
+public:
+    ~LoopbackTransport() override;
+
+    bool open(const std::string& portName, uint32_t baudRate) override;
+    void close() override;
+    bool isOpen() const override;
+    bool setBaudRate(uint32_t baudRate) override;
+
+    size_t write(std::span<const uint8_t> data) override;
+    size_t readUntil(std::span<uint8_t> buffer, Timing::Clock::time_point deadline) override;
+    size_t receiveUntil(const ReceiveSink& sink, Timing::Clock::time_point deadline) override;
+    void interrupt() override;
+    int readinessHandle() const override;
+    void purgeInput() override;
+
+private:
+    struct Channel;
+    struct Link;
+
+    std::shared_ptr<Link> link;
+    Channel* rx = nullptr;
+    Channel* tx = nullptr;
+
+    static std::shared_ptr<Link> acquireLink(const std::string& key);
+};
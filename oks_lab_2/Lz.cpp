@@ -0,0 +1,227 @@
+﻿#include "Lz.h"
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <memory>
+
+namespace {
+    const size_t MIN_MATCH = 4;
+    const size_t MAX_OFFSET = 65535;
+    // Последние байты всегда идут литералами, а совпадение не начинается
+    // ближе MATCH_LIMIT к концу: чтение по 8 байт не выходит за вход
+    const size_t LAST_LITERALS = 8;
+    const size_t MATCH_LIMIT = 12;
+    // Таблица хешей до 4096 позиций, для коротких сообщений меньше: ее обнуление
+    // иначе дороже самого сжатия
+    const int HASH_BITS = 12;
+    const int MIN_HASH_BITS = 8;
+    // Без совпадений шаг поиска растет: несжимаемые данные проходятся быстро
+    const int SKIP_SHIFT = 5;
+
+    uint32_t read32(const uint8_t* p) {
+        uint32_t v;
+        std::memcpy(&v, p, sizeof(v));
+        return v;
+    }
+
+    uint64_t read64(const uint8_t* p) {
+        uint64_t v;
+        std::memcpy(&v, p, sizeof(v));
+        return v;
+    }
+
+    uint32_t hash(uint32_t v, int bits) {
+        return (v * 2654435761u) >> (32 - bits);
+    }
+
+    // Совпадающий хвост: по 8 байт, последний кусок — побайтно
+    size_t match_length(const uint8_t* a, const uint8_t* b, const uint8_t* end) {
+        const uint8_t* start = a;
+        while (a + 8 <= end) {
+            uint64_t diff = read64(a) ^ read64(b);
+            if (diff != 0) {
+                if constexpr (std::endian::native == std::endian::little) {
+                    return static_cast<size_t>(a - start) + std::countr_zero(diff) / 8;
+                }
+                else {
+                    return static_cast<size_t>(a - start) + std::countl_zero(diff) / 8;
+                }
+            }
+            a += 8;
+            b += 8;
+        }
+        while (a < end && *a == *b) {
+            ++a;
+            ++b;
+        }
+        return static_cast<size_t>(a - start);
+    }
+
+    void put_varint(std::string& out, size_t v) {
+        while (v >= 0x80) {
+            out.push_back(static_cast<char>((v & 0x7F) | 0x80));
+            v >>= 7;
+        }
+        out.push_back(static_cast<char>(v));
+    }
+
+    // Продолжение длины, если в токене 15: байты по 255 и остаток
+    void put_length(std::string& out, size_t v) {
+        while (v >= 255) {
+            out.push_back(static_cast<char>(255));
+            v -= 255;
+        }
+        out.push_back(static_cast<char>(v));
+    }
+
+    void put_sequence(std::string& out, const uint8_t* literals, size_t literalLen, size_t offset, size_t matchLen) {
+        size_t extra = matchLen - MIN_MATCH;
+        uint8_t token = static_cast<uint8_t>((std::min<size_t>(literalLen, 15) << 4) | std::min<size_t>(extra, 15));
+        out.push_back(static_cast<char>(token));
+        if (literalLen >= 15) put_length(out, literalLen - 15);
+        out.append(reinterpret_cast<const char*>(literals), literalLen);
+        out.push_back(static_cast<char>(offset & 0xFF));
+        out.push_back(static_cast<char>(offset >> 8));
+        if (extra >= 15) put_length(out, extra - 15);
+    }
+
+    void put_last_literals(std::string& out, const uint8_t* literals, size_t literalLen) {
+        out.push_back(static_cast<char>(std::min<size_t>(literalLen, 15) << 4));
+        if (literalLen >= 15) put_length(out, literalLen - 15);
+        out.append(reinterpret_cast<const char*>(literals), literalLen);
+    }
+
+    bool get_varint(std::span<const uint8_t> in, size_t& pos, size_t& value) {
+        value = 0;
+        for (int shift = 0; shift < 35; shift += 7) {
+            if (pos >= in.size()) return false;
+            uint8_t b = in[pos++];
+            value |= static_cast<size_t>(b & 0x7F) << shift;
+            if (!(b & 0x80)) return true;
+        }
+        return false;
+    }
+
+    // Длина не больше limit, иначе блок поврежден
+    bool get_length(std::span<const uint8_t> in, size_t& pos, size_t& value, size_t limit) {
+        uint8_t b;
+        do {
+            if (pos >= in.size()) return false;
+            b = in[pos++];
+            value += b;
+            if (value > limit) return false;
+        } while (b == 255);
+        return true;
+    }
+}
+
+namespace Lz {
+
+    bool compress(std::span<const uint8_t> in, std::string& out) {
+        out.clear();
+        const size_t n = in.size();
+        if (n < MIN_INPUT) return false;
+
+        // Блок длиннее исходных не нужен: сжатие прерывается, как только его превысит
+        out.reserve(n + 16);
+        put_varint(out, n);
+
+        const uint8_t* base = in.data();
+        const uint8_t* end = base + n;
+        const size_t matchLimit = n - MATCH_LIMIT;
+        const uint8_t* matchEnd = end - LAST_LITERALS;
+
+        const int hashBits = std::clamp(static_cast<int>(std::bit_width(n)), MIN_HASH_BITS, HASH_BITS);
+        std::unique_ptr<uint32_t[]> table(new uint32_t[size_t(1) << hashBits]());
+
+        size_t anchor = 0;
+        size_t i = 0;
+        size_t misses = 0;
+        while (i < matchLimit) {
+            uint32_t v = read32(base + i);
+            uint32_t& slot = table[hash(v, hashBits)];
+            size_t candidate = slot;
+            slot = static_cast<uint32_t>(i);
+
+            if (candidate >= i || i - candidate > MAX_OFFSET || read32(base + candidate) != v) {
+                i += 1 + (misses++ >> SKIP_SHIFT);
+                continue;
+            }
+            misses = 0;
+
+            // Совпадение продлевается назад за счет литералов
+            while (i > anchor && candidate > 0 && base[i - 1] == base[candidate - 1]) {
+                --i;
+                --candidate;
+            }
+            size_t len = MIN_MATCH + match_length(base + i + MIN_MATCH, base + candidate + MIN_MATCH, matchEnd);
+
+            put_sequence(out, base + anchor, i - anchor, i - candidate, len);
+            if (out.size() >= n) return false;
+
+            i += len;
+            anchor = i;
+            if (i < matchLimit) {
+                table[hash(read32(base + i - 2), hashBits)] = static_cast<uint32_t>(i - 2);
+            }
+        }
+
+        put_last_literals(out, base + anchor, n - anchor);
+        return out.size() < n;
+    }
+
+    size_t decompress(std::span<const uint8_t> in, std::string& out) {
+        size_t pos = 0;
+        size_t rawSize = 0;
+        if (!get_varint(in, pos, rawSize) || rawSize == 0) return 0;
+        // Длина из поврежденного блока не должна раздувать буфер: байт блока
+        // дает не больше 255 байт результата
+        if (rawSize / 255 > in.size()) return 0;
+
+        const size_t outBase = out.size();
+        out.resize(outBase + rawSize);
+        char* dst = out.data() + outBase;
+        size_t produced = 0;
+
+        auto fail = [&]() -> size_t {
+            out.resize(outBase);
+            return 0;
+        };
+
+        while (true) {
+            if (pos >= in.size()) return fail();
+            uint8_t token = in[pos++];
+
+            size_t literalLen = token >> 4;
+            if (literalLen == 15 && !get_length(in, pos, literalLen, rawSize)) return fail();
+            if (literalLen > rawSize - produced || literalLen > in.size() - pos) return fail();
+            std::memcpy(dst + produced, in.data() + pos, literalLen);
+            pos += literalLen;
+            produced += literalLen;
+
+            // Последняя последовательность — только литералы
+            if (produced == rawSize) return pos;
+
+            if (in.size() - pos < 2) return fail();
+            size_t offset = static_cast<size_t>(in[pos]) | (static_cast<size_t>(in[pos + 1]) << 8);
+            pos += 2;
+            if (offset == 0 || offset > produced) return fail();
+
+            size_t matchLen = token & 0x0F;
+            if (matchLen == 15 && !get_length(in, pos, matchLen, rawSize)) return fail();
+            matchLen += MIN_MATCH;
+            if (matchLen > rawSize - produced) return fail();
+
+            char* to = dst + produced;
+            const char* from = to - offset;
+            if (offset >= matchLen) {
+                std::memcpy(to, from, matchLen);
+            }
+            else {
+                // Перекрытие: повтор короткого шаблона
+                for (size_t k = 0; k < matchLen; ++k) to[k] = from[k];
+            }
+            produced += matchLen;
+        }
+    }
+}
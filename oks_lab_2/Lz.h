@@ -0,0 +1,23 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <span>
+#include <string>
+
+//  LZ-      (   LZ4).
+// :    (varint),  
+// " + "    64 .  :
+//      .
+namespace Lz {
+    //     
+    const size_t MIN_INPUT = 16;
+
+    //  in  out (out ). false    :
+    //    ,       
+    bool compress(std::span<const uint8_t> in, std::string& out);
+
+    //      in      out.
+    //    ; 0       ,
+    // out    
+    size_t decompress(std::span<const uint8_t> in, std::string& out);
+}
@@ -0,0 +1,113 @@
+#pragma once
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+//         .
+//      :   
+// compare_exchange  tail     , 
+//     .    ,  .
+//      SpscQueue.
+template <typename T, size_t Capacity>
+class MpscQueue {
+    static_assert(std::has_single_bit(Capacity), "Capacity must be a power of two");
+
+public:
+    MpscQueue() : cells(std::make_unique<Cell[]>(Capacity)) {
+        for (size_t i = 0; i < Capacity; ++i) {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    // ---  ---
+
+    // false   ,   
+    bool push(T&& value) {
+        size_t pos = tail.load(std::memory_order_relaxed);
+        Cell* cell;
+        while (true) {
+            cell = &cells[pos & MASK];
+            size_t seq = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            }
+            else if (diff < 0) {
+                overflows.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            else {
+                pos = tail.load(std::memory_order_relaxed);
+            }
+        }
+        cell->value = std::move(value);
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        notify();
+        return true;
+    }
+
+    // ---  ---
+
+    bool pop(T& out) {
+        Cell& cell = cells[head & MASK];
+        if (cell.sequence.load(std::memory_order_acquire) != head + 1) return false;
+        out = std::move(cell.value);
+        cell.sequence.store(head + Capacity, std::memory_order_release);
+        ++head;
+        return true;
+    }
+
+    bool empty() const {
+        return cells[head & MASK].sequence.load(std::memory_order_acquire) != head + 1;
+    }
+
+    // ,     . false   -
+    bool waitFor(std::chrono::milliseconds timeout) {
+        if (!empty()) return true;
+
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        std::unique_lock<std::mutex> lock(waitMutex);
+        waiters.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        bool ready = wakeup.wait_until(lock, deadline, [this] { return !empty(); });
+        waiters.fetch_sub(1, std::memory_order_relaxed);
+        return ready;
+    }
+
+    //    - 
+    size_t overflowCount() const { return overflows.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr size_t MASK = Capacity - 1;
+
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    std::unique_ptr<Cell[]> cells;
+
+    alignas(64) size_t head = 0;                //  
+    alignas(64) std::atomic<size_t> tail{ 0 };  //   
+    std::atomic<size_t> overflows{ 0 };
+
+    alignas(64) std::atomic<int> waiters{ 0 };
+    std::mutex waitMutex;
+    std::condition_variable wakeup;
+
+    void notify() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiters.load(std::memory_order_relaxed) > 0) {
+            std::lock_guard<std::mutex> lock(waitMutex);
+            wakeup.notify_one();
+        }
+    }
+};
@@ -0,0 +1,55 @@
+﻿#include "PayloadSizer.h"
+#include "Frame.h"
+#include <cmath>
+
+namespace {
+    // Служебные байты кадра: заголовок, флаги, ENQ/ACK захвата канала
+    const double OVERHEAD_BYTES = Frame::HEADER_SIZE + 2 + 2;
+
+    // Вес истории на каждый новый кадр
+    const double HISTORY_DECAY = 0.9;
+}
+
+void PayloadSizer::setFixed(size_t size) {
+    mode = Mode::Fixed;
+    current = std::clamp<size_t>(size, 1, MAX_PAYLOAD);
+    minSize = current;
+    maxSize = current;
+}
+
+void PayloadSizer::setAdaptive(size_t newMin, size_t newMax) {
+    mode = Mode::Adaptive;
+    minSize = std::clamp<size_t>(newMin, 1, MAX_PAYLOAD);
+    maxSize = std::clamp<size_t>(newMax, minSize, MAX_PAYLOAD);
+    current = minSize; // о линии ничего не известно — начинаем с малого кадра
+    lossEvents = 0.0;
+    bytesSeen = 0.0;
+}
+
+// Максимум L * (1 - p)^L / (L + H): L^2 + H*L - H / a = 0, где a = -ln(1 - p)
+size_t PayloadSizer::targetPayload() const {
+    if (lossEvents <= 0.0 || bytesSeen <= 0.0) {
+        return maxSize;
+    }
+    double p = std::min(lossEvents / bytesSeen, 0.5);
+    double a = -std::log1p(-p);
+    double h = OVERHEAD_BYTES;
+    double optimal = (-h + std::sqrt(h * h + 4.0 * h / a)) / 2.0;
+    return std::clamp(static_cast<size_t>(optimal), minSize, maxSize);
+}
+
+void PayloadSizer::onFrameResult(size_t wireBytes, int collisions, int uncorrectable) {
+    if (mode != Mode::Adaptive) return;
+
+    // Каждая попытка с коллизией тоже занимала линию
+    lossEvents = lossEvents * HISTORY_DECAY + collisions + uncorrectable;
+    bytesSeen = bytesSeen * HISTORY_DECAY + static_cast<double>(wireBytes) * (1 + collisions);
+
+    size_t target = targetPayload();
+    if (current > target) {
+        current = std::max(target, current / 2);
+    }
+    else {
+        current = std::min(target, current + ADAPTIVE_STEP);
+    }
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include <cstddef>
+#include <algorithm>
+
+//       .
+//          
+//     p,      ,   
+//  L * (1 - p)^L / (L +  ) .   
+//        ,    
+//  .       ,   .
+class PayloadSizer {
+public:
+    enum class Mode {
+        Fixed,
+        Adaptive
+    };
+
+    static const size_t MAX_PAYLOAD = 65535;    //   dataLen
+    static const size_t DEFAULT_PAYLOAD = 32;
+    static const size_t ADAPTIVE_MIN = 8;
+    static const size_t ADAPTIVE_MAX = 4096;
+    static const size_t ADAPTIVE_STEP = 16;
+
+    void setFixed(size_t size);
+    void setAdaptive(size_t minSize, size_t maxSize);
+
+    Mode getMode() const { return mode; }
+    size_t getCurrent() const { return current; }
+    size_t getMin() const { return minSize; }
+    size_t getMax() const { return maxSize; }
+
+    //    ,   remaining 
+    size_t next(size_t remaining) const { return std::min(current, remaining); }
+
+    //     wireBytes   
+    void onFrameResult(size_t wireBytes, int collisions, int uncorrectable);
+
+private:
+    Mode mode = Mode::Fixed;
+    size_t current = DEFAULT_PAYLOAD;
+    size_t minSize = DEFAULT_PAYLOAD;
+    size_t maxSize = DEFAULT_PAYLOAD;
+
+    //      
+    double lossEvents = 0.0;
+    double bytesSeen = 0.0;
+
+    size_t targetPayload() const;
+};
@@ -0,0 +1,166 @@
+﻿#include "PosixSerialTransport.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+#include <cerrno>
+
+namespace {
+    struct BaudEntry {
+        uint32_t baud;
+        speed_t speed;
+    };
+
+    const BaudEntry BAUD_TABLE[] = {
+        { 50, B50 }, { 75, B75 }, { 110, B110 }, { 134, B134 }, { 150, B150 },
+        { 200, B200 }, { 300, B300 }, { 600, B600 }, { 1200, B1200 }, { 1800, B1800 },
+        { 2400, B2400 }, { 4800, B4800 }, { 9600, B9600 }, { 19200, B19200 },
+        { 38400, B38400 }, { 57600, B57600 }, { 115200, B115200 },
+#ifdef B230400
+        { 230400, B230400 },
+#endif
+#ifdef B460800
+        { 460800, B460800 },
+#endif
+#ifdef B921600
+        { 921600, B921600 },
+#endif
+    };
+
+    bool lookup_speed(uint32_t baudRate, speed_t& speed) {
+        for (const auto& entry : BAUD_TABLE) {
+            if (entry.baud == baudRate) {
+                speed = entry.speed;
+                return true;
+            }
+        }
+        return false;
+    }
+}
+
+PosixSerialTransport::PosixSerialTransport() {
+    if (pipe(wakePipe) == 0) {
+        for (int end : wakePipe) {
+            fcntl(end, F_SETFL, fcntl(end, F_GETFL) | O_NONBLOCK);
+            fcntl(end, F_SETFD, FD_CLOEXEC);
+        }
+    }
+    else {
+        wakePipe[0] = wakePipe[1] = -1;
+    }
+}
+
+PosixSerialTransport::~PosixSerialTransport() {
+    close();
+    for (int end : wakePipe) {
+        if (end >= 0) ::close(end);
+    }
+}
+
+bool PosixSerialTransport::open(const std::string& portName, uint32_t baudRate) {
+    close();
+
+    std::string path = portName.find('/') == std::string::npos ? "/dev/" + portName : portName;
+    fd = ::open(path.c_str(), O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0) return false;
+    ownsFd = true;
+
+    if (!configure(baudRate)) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool PosixSerialTransport::configure(uint32_t baudRate) {
+    // Скорости нет в таблице — порт не открывается, как и в setBaudRate
+    speed_t speed;
+    if (!lookup_speed(baudRate, speed)) return false;
+
+    termios tty;
+    if (tcgetattr(fd, &tty) != 0) return false;
+
+    cfmakeraw(&tty);
+    tty.c_cflag |= CLOCAL | CREAD;
+    tty.c_cflag &= ~(CSTOPB | PARENB | CRTSCTS);
+    tty.c_cc[VMIN] = 0;
+    tty.c_cc[VTIME] = 0;
+
+    cfsetispeed(&tty, speed);
+    cfsetospeed(&tty, speed);
+    return tcsetattr(fd, TCSANOW, &tty) == 0;
+}
+
+void PosixSerialTransport::close() {
+    if (fd >= 0 && ownsFd) {
+        ::close(fd);
+    }
+    fd = -1;
+}
+
+bool PosixSerialTransport::isOpen() const {
+    return fd >= 0;
+}
+
+bool PosixSerialTransport::setBaudRate(uint32_t baudRate) {
+    speed_t speed;
+    if (!lookup_speed(baudRate, speed)) return false;
+
+    termios tty;
+    if (tcgetattr(fd, &tty) != 0) return false;
+    cfsetispeed(&tty, speed);
+    cfsetospeed(&tty, speed);
+    return tcsetattr(fd, TCSANOW, &tty) == 0;
+}
+
+size_t PosixSerialTransport::write(std::span<const uint8_t> data) {
+    size_t written = 0;
+    while (written < data.size()) {
+        ssize_t n = ::write(fd, data.data() + written, data.size() - written);
+        if (n > 0) {
+            written += static_cast<size_t>(n);
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && errno == EAGAIN) {
+            // Выходной буфер драйвера заполнен, ждем освобождения
+            pollfd pfd = { fd, POLLOUT, 0 };
+            if (poll(&pfd, 1, 100) <= 0) break;
+            continue;
+        }
+        break;
+    }
+    return written;
+}
+
+size_t PosixSerialTransport::readUntil(std::span<uint8_t> buffer, Timing::Clock::time_point deadline) {
+    pollfd pfds[2] = { { fd, POLLIN, 0 }, { wakePipe[0], POLLIN, 0 } };
+    int ready = Timing::poll_until(pfds, 2, deadline);
+    if (ready <= 0) return 0;
+
+    if (pfds[1].revents & POLLIN) {
+        uint8_t drain[16];
+        while (::read(wakePipe[0], drain, sizeof(drain)) > 0) {
+        }
+        return 0;
+    }
+    if (!(pfds[0].revents & POLLIN)) return 0;
+
+    ssize_t n = ::read(fd, buffer.data(), buffer.size());
+    return n > 0 ? static_cast<size_t>(n) : 0;
+}
+
+void PosixSerialTransport::interrupt() {
+    uint8_t signal = 1;
+    if (wakePipe[1] >= 0) {
+        [[maybe_unused]] ssize_t n = ::write(wakePipe[1], &signal, 1);
+    }
+}
+
+void PosixSerialTransport::purgeInput() {
+    tcflush(fd, TCIFLUSH);
+}
+
+#endif
@@ -0,0 +1,31 @@
+#pragma once
+#ifndef _WIN32
+#include "Transport.h"
+
+//    termios: /dev/ttyS*, /dev/ttyUSB*  ..
+//      /dev/.
+class PosixSerialTransport : public Transport {
+public:
+    PosixSerialTransport();
+    ~PosixSerialTransport() override;
+
+    bool open(const std::string& portName, uint32_t baudRate) override;
+    void close() override;
+    bool isOpen() const override;
+    bool setBaudRate(uint32_t baudRate) override;
+
+    size_t write(std::span<const uint8_t> data) override;
+    size_t readUntil(std::span<uint8_t> buffer, Timing::Clock::time_point deadline) override;
+    void interrupt() override;
+    int readinessHandle() const override { return fd; }
+    void purgeInput() override;
+
+protected:
+    int fd = -1;
+    bool ownsFd = true;
+    int wakePipe[2] = { -1, -1 }; // interrupt():     poll
+
+    //      8N1   
+    bool configure(uint32_t baudRate);
+};
+#endif
@@ -0,0 +1,80 @@
+﻿#include "PtyTransport.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+#include <cstdlib>
+#include <map>
+#include <mutex>
+
+// Оба конца пары живут, пока открыт хотя бы один транспорт
+struct PtyTransport::Pair {
+    int masterFd = -1;
+    int slaveFd = -1;
+    std::string slavePath;
+
+    ~Pair() {
+        if (slaveFd >= 0) ::close(slaveFd);
+        if (masterFd >= 0) ::close(masterFd);
+    }
+};
+
+std::shared_ptr<PtyTransport::Pair> PtyTransport::acquirePair(const std::string& key) {
+    static std::mutex registryMutex;
+    static std::map<std::string, std::weak_ptr<Pair>> registry;
+
+    std::lock_guard<std::mutex> lock(registryMutex);
+    if (auto existing = registry[key].lock()) {
+        return existing;
+    }
+
+    auto created = std::make_shared<Pair>();
+    created->masterFd = posix_openpt(O_RDWR | O_NOCTTY | O_CLOEXEC);
+    if (created->masterFd < 0 || grantpt(created->masterFd) != 0 || unlockpt(created->masterFd) != 0) {
+        return nullptr;
+    }
+    const char* name = ptsname(created->masterFd);
+    if (!name) return nullptr;
+    created->slavePath = name;
+
+    // Ведомая сторона держится открытой, чтобы сырой режим не сбрасывался
+    created->slaveFd = ::open(name, O_RDWR | O_NOCTTY | O_CLOEXEC);
+    if (created->slaveFd < 0) return nullptr;
+    fcntl(created->masterFd, F_SETFL, fcntl(created->masterFd, F_GETFL) | O_NONBLOCK);
+    fcntl(created->slaveFd, F_SETFL, fcntl(created->slaveFd, F_GETFL) | O_NONBLOCK);
+
+    registry[key] = created;
+    return created;
+}
+
+bool PtyTransport::open(const std::string& portName, uint32_t baudRate) {
+    close();
+    if (portName.size() < 2) return false;
+
+    char end = portName.back();
+    if (end != 'A' && end != 'B') return false;
+
+    pair = acquirePair(portName.substr(0, portName.size() - 1));
+    if (!pair) return false;
+
+    fd = (end == 'A') ? pair->masterFd : pair->slaveFd;
+    ownsFd = false;
+    if (!configure(baudRate)) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void PtyTransport::close() {
+    PosixSerialTransport::close();
+    pair.reset();
+}
+
+const std::string& PtyTransport::slavePath() const {
+    static const std::string empty;
+    return pair ? pair->slavePath : empty;
+}
+
+#endif
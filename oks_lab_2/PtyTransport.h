@@ -0,0 +1,21 @@
+#pragma once
+#ifndef _WIN32
+#include <memory>
+#include "PosixSerialTransport.h"
+
+//  : PTY<n>A   , PTY<n>B  .
+//         slavePath().
+class PtyTransport : public PosixSerialTransport {
+public:
+    bool open(const std::string& portName, uint32_t baudRate) override;
+    void close() override;
+
+    const std::string& slavePath() const;
+
+private:
+    struct Pair;
+    std::shared_ptr<Pair> pair;
+
+    static std::shared_ptr<Pair> acquirePair(const std::string& key);
+};
+#endif
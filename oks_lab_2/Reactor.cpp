@@ -0,0 +1,158 @@
+﻿#include "Reactor.h"
+
+#ifdef __linux__
+#include <algorithm>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+#include <cerrno>
+
+namespace {
+    const int MAX_EVENTS = 64;
+}
+
+Reactor::Reactor() {
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (!valid()) return;
+
+    for (int fd : { timerFd, wakeFd }) {
+        epoll_event ev = {};
+        ev.events = EPOLLIN;
+        ev.data.fd = fd;
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &ev);
+    }
+}
+
+Reactor::~Reactor() {
+    for (int fd : { epollFd, timerFd, wakeFd }) {
+        if (fd >= 0) close(fd);
+    }
+}
+
+bool Reactor::watch(int fd, Callback onReadable) {
+    epoll_event ev = {};
+    ev.events = EPOLLIN;
+    ev.data.fd = fd;
+    if (epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &ev) != 0) return false;
+    watchers[fd] = std::make_shared<Callback>(std::move(onReadable));
+    return true;
+}
+
+void Reactor::unwatch(int fd) {
+    if (watchers.erase(fd) > 0) {
+        epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+    }
+}
+
+Reactor::TimerId Reactor::addTimer(Timing::Clock::time_point when, Callback callback) {
+    TimerId id = nextTimerId++;
+    timers.emplace(TimerKey(when, id), std::move(callback));
+    timerIndex.emplace(id, when);
+    if (when < armedAt) armTimer();
+    return id;
+}
+
+void Reactor::cancelTimer(TimerId id) {
+    auto it = timerIndex.find(id);
+    if (it == timerIndex.end()) return;
+    timers.erase(TimerKey(it->second, id));
+    timerIndex.erase(it);
+    // Лишнее срабатывание timerfd безвредно: fireTimers перевзведет его
+}
+
+// Взводит timerfd на ближайший срок. steady_clock в Linux — это CLOCK_MONOTONIC
+void Reactor::armTimer() {
+    itimerspec spec = {};
+    armedAt = timers.empty() ? Timing::NO_DEADLINE : timers.begin()->first.first;
+    if (!timers.empty()) {
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(armedAt.time_since_epoch()).count();
+        ns = std::max<long long>(ns, 1); // нулевое значение снимает таймер
+        spec.it_value.tv_sec = static_cast<time_t>(ns / 1000000000);
+        spec.it_value.tv_nsec = static_cast<long>(ns % 1000000000);
+    }
+    timerfd_settime(timerFd, TFD_TIMER_ABSTIME, &spec, nullptr);
+}
+
+void Reactor::fireTimers() {
+    uint64_t expirations;
+    while (read(timerFd, &expirations, sizeof(expirations)) > 0) {
+    }
+
+    // Таймеры, добавленные обработчиками на уже прошедший срок, ждут следующей итерации
+    auto now = Timing::Clock::now();
+    TimerId lastId = nextTimerId;
+    while (!timers.empty()) {
+        auto it = timers.begin();
+        if (it->first.first > now || it->first.second >= lastId) break;
+        Callback callback = std::move(it->second);
+        timerIndex.erase(it->first.second);
+        timers.erase(it);
+        callback();
+    }
+    armTimer();
+}
+
+void Reactor::post(Callback callback) {
+    {
+        std::lock_guard<std::mutex> lock(postMutex);
+        posted.push_back(std::move(callback));
+    }
+    uint64_t one = 1;
+    [[maybe_unused]] ssize_t n = write(wakeFd, &one, sizeof(one));
+}
+
+void Reactor::runPosted() {
+    uint64_t count;
+    while (read(wakeFd, &count, sizeof(count)) > 0) {
+    }
+    {
+        std::lock_guard<std::mutex> lock(postMutex);
+        running.swap(posted);
+    }
+    for (Callback& callback : running) {
+        callback();
+    }
+    running.clear();
+}
+
+void Reactor::runOnce(Timing::Clock::time_point deadline) {
+    epoll_event events[MAX_EVENTS];
+    int timeoutMs = deadline == Timing::NO_DEADLINE ? -1 : Timing::remaining_ms(deadline, 1 << 30);
+    int count = epoll_wait(epollFd, events, MAX_EVENTS, timeoutMs);
+    if (count < 0) return; // EINTR
+
+    for (int i = 0; i < count; ++i) {
+        int fd = events[i].data.fd;
+        if (fd == timerFd) {
+            fireTimers();
+        }
+        else if (fd == wakeFd) {
+            runPosted();
+        }
+        else if (!(events[i].events & EPOLLIN)) {
+            unwatch(fd); // ошибка или обрыв без данных: иначе epoll будет будить без конца
+        }
+        else {
+            auto it = watchers.find(fd);
+            if (it == watchers.end()) continue; // снят с наблюдения в этой итерации
+            std::shared_ptr<Callback> callback = it->second;
+            (*callback)();
+        }
+    }
+}
+
+void Reactor::run() {
+    stopping = false;
+    while (!stopping) {
+        runOnce(Timing::NO_DEADLINE);
+    }
+}
+
+void Reactor::stop() {
+    post([this] { stopping = true; });
+}
+
+#endif
@@ -0,0 +1,69 @@
+#pragma once
+#ifdef __linux__
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <unordered_map>
+#include <vector>
+#include "Timing.h"
+
+//     epoll:    ,
+//     ( timerfd  )     .
+//      run();  
+//     ,     .
+class Reactor {
+public:
+    using Callback = std::function<void()>;
+    using TimerId = uint64_t;
+
+    Reactor();
+    ~Reactor();
+
+    Reactor(const Reactor&) = delete;
+    Reactor& operator=(const Reactor&) = delete;
+
+    bool valid() const { return epollFd >= 0 && timerFd >= 0 && wakeFd >= 0; }
+
+    //  onReadable,   fd   (  )
+    bool watch(int fd, Callback onReadable);
+    void unwatch(int fd);
+
+    TimerId addTimer(Timing::Clock::time_point when, Callback callback);
+    void cancelTimer(TimerId id);
+
+    //  callback   .     
+    void post(Callback callback);
+
+    //    stop()
+    void run();
+    //  :     deadline
+    void runOnce(Timing::Clock::time_point deadline);
+    void stop();
+
+private:
+    int epollFd = -1;
+    int timerFd = -1;
+    int wakeFd = -1;   // eventfd: post()  stop()
+
+    // shared_ptr:         
+    std::unordered_map<int, std::shared_ptr<Callback>> watchers;
+
+    using TimerKey = std::pair<Timing::Clock::time_point, TimerId>;
+    std::map<TimerKey, Callback> timers;
+    std::unordered_map<TimerId, Timing::Clock::time_point> timerIndex;
+    TimerId nextTimerId = 1;
+    Timing::Clock::time_point armedAt = Timing::NO_DEADLINE;
+
+    std::mutex postMutex;
+    std::vector<Callback> posted;
+    std::vector<Callback> running;
+    std::atomic<bool> stopping{ false };
+
+    void armTimer();
+    void fireTimers();
+    void runPosted();
+};
+#endif
@@ -0,0 +1,161 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <algorithm>
+#include <iterator>
+#include <span>
+#include "BufferPool.h"
+
+//       N .    
+//    N   ,   .
+//      BufferPool:   
+//    .
+template <size_t N>
+class SmallBuffer {
+public:
+    SmallBuffer() = default;
+
+    SmallBuffer(const SmallBuffer& other) {
+        assign(other.begin(), other.end());
+    }
+
+    SmallBuffer(SmallBuffer&& other) noexcept {
+        take(other);
+    }
+
+    ~SmallBuffer() {
+        release_storage();
+    }
+
+    SmallBuffer& operator=(const SmallBuffer& other) {
+        if (this != &other) {
+            assign(other.begin(), other.end());
+        }
+        return *this;
+    }
+
+    SmallBuffer& operator=(SmallBuffer&& other) noexcept {
+        if (this != &other) {
+            release_storage();
+            take(other);
+        }
+        return *this;
+    }
+
+    uint8_t* data() { return heap ? heap : inlineStorage; }
+    const uint8_t* data() const { return heap ? heap : inlineStorage; }
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    size_t capacity() const { return heap ? heapCapacity : N; }
+
+    uint8_t* begin() { return data(); }
+    uint8_t* end() { return data() + count; }
+    const uint8_t* begin() const { return data(); }
+    const uint8_t* end() const { return data() + count; }
+
+    uint8_t& operator[](size_t i) { return data()[i]; }
+    const uint8_t& operator[](size_t i) const { return data()[i]; }
+
+    void reserve(size_t n) {
+        if (n <= capacity()) return;
+        uint8_t* grown = new uint8_t[n];
+        std::memcpy(grown, data(), count);
+        release_storage();
+        heap = grown;
+        heapCapacity = n;
+    }
+
+    //  ,     ;      
+    void reserve(size_t n, BufferPool& pool) {
+        if (n <= capacity()) return;
+        BufferPool::Block* block = pool.acquire(n);
+        if (!block) {
+            reserve(n);
+            return;
+        }
+        uint8_t* grown = BufferPool::bytes(block);
+        std::memcpy(grown, data(), count);
+        release_storage();
+        pooled = block;
+        heap = grown;
+        heapCapacity = BufferPool::capacity(block);
+    }
+
+    //   ,   std::vector
+    void resize(size_t n) {
+        reserve(n);
+        if (n > count) {
+            std::memset(data() + count, 0, n - count);
+        }
+        count = n;
+    }
+
+    void clear() { count = 0; }
+
+    void push_back(uint8_t b) {
+        if (count == capacity()) {
+            reserve(std::max<size_t>(capacity() * 2, N + 1));
+        }
+        data()[count++] = b;
+    }
+
+    void append(const uint8_t* bytes, size_t n) {
+        if (count + n > capacity()) {
+            reserve(std::max(count + n, capacity() * 2));
+        }
+        std::memcpy(data() + count, bytes, n);
+        count += n;
+    }
+
+    template <typename It>
+    void assign(It first, It last) {
+        size_t n = static_cast<size_t>(std::distance(first, last));
+        reserve(n);
+        std::copy(first, last, data());
+        count = n;
+    }
+
+    void assign(std::span<const uint8_t> bytes) {
+        assign(bytes.begin(), bytes.end());
+    }
+
+    friend bool operator==(const SmallBuffer& a, const SmallBuffer& b) {
+        return a.count == b.count && std::equal(a.begin(), a.end(), b.begin());
+    }
+
+private:
+    uint8_t inlineStorage[N];
+    uint8_t* heap = nullptr;
+    size_t heapCapacity = 0;
+    size_t count = 0;
+    BufferPool::Block* pooled = nullptr;   //  heap,    
+
+    void release_storage() {
+        if (pooled) {
+            BufferPool::release(pooled);
+        }
+        else {
+            delete[] heap;
+        }
+        pooled = nullptr;
+        heap = nullptr;
+        heapCapacity = 0;
+    }
+
+    void take(SmallBuffer& other) {
+        count = other.count;
+        if (other.heap) {
+            heap = other.heap;
+            heapCapacity = other.heapCapacity;
+            pooled = other.pooled;
+            other.heap = nullptr;
+            other.pooled = nullptr;
+            other.heapCapacity = 0;
+        }
+        else {
+            std::memcpy(inlineStorage, other.inlineStorage, count);
+        }
+        other.count = 0;
+    }
+};
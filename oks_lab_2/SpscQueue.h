@@ -0,0 +1,112 @@
+#pragma once
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+
+//         .
+//    ;         std::move.
+//      :   
+//      ( ).
+template <typename T, size_t Capacity>
+class SpscQueue {
+    static_assert(std::has_single_bit(Capacity), "Capacity must be a power of two");
+
+public:
+    SpscQueue() : slots(std::make_unique<T[]>(Capacity)) {}
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    // ---  ---
+
+    // false   ,   
+    bool push(T&& value) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t - cachedHead == Capacity) {
+            cachedHead = head.load(std::memory_order_acquire);
+            if (t - cachedHead == Capacity) {
+                overflows.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+        }
+        slots[t & MASK] = std::move(value);
+        tail.store(t + 1, std::memory_order_release);
+        notify();
+        return true;
+    }
+
+    // ---  ---
+
+    bool pop(T& out) {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h == cachedTail) {
+            cachedTail = tail.load(std::memory_order_acquire);
+            if (h == cachedTail) return false;
+        }
+        out = std::move(slots[h & MASK]);
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    //      out(T&&),   
+    template <typename Out>
+    size_t drain(Out&& out) {
+        size_t h = head.load(std::memory_order_relaxed);
+        cachedTail = tail.load(std::memory_order_acquire);
+        size_t n = cachedTail - h;
+        for (size_t i = 0; i < n; ++i) {
+            out(std::move(slots[(h + i) & MASK]));
+        }
+        head.store(h + n, std::memory_order_release);
+        return n;
+    }
+
+    // ,     . false   -
+    bool waitFor(std::chrono::milliseconds timeout) {
+        if (!empty()) return true;
+
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        std::unique_lock<std::mutex> lock(waitMutex);
+        waiters.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        bool ready = wakeup.wait_until(lock, deadline, [this] { return !empty(); });
+        waiters.fetch_sub(1, std::memory_order_relaxed);
+        return ready;
+    }
+
+    bool empty() const {
+        return head.load(std::memory_order_relaxed) == tail.load(std::memory_order_acquire);
+    }
+
+    //    - 
+    size_t overflowCount() const { return overflows.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr size_t MASK = Capacity - 1;
+
+    std::unique_ptr<T[]> slots;
+
+    alignas(64) std::atomic<size_t> head{ 0 };  //  
+    size_t cachedTail = 0;                      //  tail  
+    alignas(64) std::atomic<size_t> tail{ 0 };  //  
+    size_t cachedHead = 0;                      //  head  
+    std::atomic<size_t> overflows{ 0 };
+
+    alignas(64) std::atomic<int> waiters{ 0 };
+    std::mutex waitMutex;
+    std::condition_variable wakeup;
+
+    void notify() {
+        //   fetch_add  waitFor:     tail,
+        //    
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiters.load(std::memory_order_relaxed) > 0) {
+            std::lock_guard<std::mutex> lock(waitMutex);
+            wakeup.notify_one();
+        }
+    }
+};
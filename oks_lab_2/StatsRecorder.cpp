@@ -0,0 +1,183 @@
+﻿#include "StatsRecorder.h"
+#include <algorithm>
+#include <bit>
+#include <thread>
+
+namespace CSMA {
+
+    namespace {
+        const unsigned MAX_SHARDS = 16;
+
+        // Номер потока выдается один раз при первой записи
+        std::atomic<unsigned> nextThreadSlot{ 0 };
+
+        unsigned thread_slot() {
+            thread_local const unsigned slot = nextThreadSlot.fetch_add(1, std::memory_order_relaxed);
+            return slot;
+        }
+    }
+
+    // --- HistogramSnapshot ---
+
+    int HistogramSnapshot::bucketOf(uint64_t value) {
+        if (value < SUB_BUCKETS) return static_cast<int>(value);
+        int octave = static_cast<int>(std::bit_width(value)) - 1;
+        if (octave >= MAX_BITS) return BUCKETS - 1;
+        int sub = static_cast<int>(value >> (octave - SUB_BITS)) & (SUB_BUCKETS - 1);
+        return (octave - SUB_BITS + 1) * SUB_BUCKETS + sub;
+    }
+
+    uint64_t HistogramSnapshot::bucketLowerBound(int bucket) {
+        if (bucket < SUB_BUCKETS) return static_cast<uint64_t>(bucket);
+        int octave = bucket / SUB_BUCKETS + SUB_BITS - 1;
+        uint64_t sub = static_cast<uint64_t>(bucket % SUB_BUCKETS);
+        return (SUB_BUCKETS + sub) << (octave - SUB_BITS);
+    }
+
+    uint64_t HistogramSnapshot::bucketUpperBound(int bucket) {
+        if (bucket < SUB_BUCKETS) return static_cast<uint64_t>(bucket);
+        int octave = bucket / SUB_BUCKETS + SUB_BITS - 1;
+        return bucketLowerBound(bucket) + (uint64_t(1) << (octave - SUB_BITS)) - 1;
+    }
+
+    uint64_t HistogramSnapshot::percentile(double p) const {
+        if (count == 0) return 0;
+        uint64_t rank = static_cast<uint64_t>(std::clamp(p, 0.0, 1.0) * (count - 1)) + 1;
+        uint64_t seen = 0;
+        for (int i = 0; i < BUCKETS; ++i) {
+            if (seen + buckets[i] < rank) {
+                seen += buckets[i];
+                continue;
+            }
+            // Значения внутри корзины считаются равномерно распределенными
+            uint64_t low = bucketLowerBound(i);
+            double width = static_cast<double>(bucketUpperBound(i) - low + 1);
+            double offset = width * (static_cast<double>(rank - seen) - 0.5) / static_cast<double>(buckets[i]);
+            return std::min(low + static_cast<uint64_t>(offset), bucketUpperBound(i));
+        }
+        return bucketUpperBound(BUCKETS - 1);
+    }
+
+    uint64_t HistogramSnapshot::max() const {
+        for (int i = BUCKETS - 1; i >= 0; --i) {
+            if (buckets[i] > 0) return bucketUpperBound(i);
+        }
+        return 0;
+    }
+
+    HistogramSnapshot& HistogramSnapshot::operator+=(const HistogramSnapshot& other) {
+        for (int i = 0; i < BUCKETS; ++i) {
+            buckets[i] += other.buckets[i];
+        }
+        count += other.count;
+        sum += other.sum;
+        return *this;
+    }
+
+    HistogramSnapshot& HistogramSnapshot::operator-=(const HistogramSnapshot& base) {
+        for (int i = 0; i < BUCKETS; ++i) {
+            buckets[i] -= base.buckets[i];
+        }
+        count -= base.count;
+        sum -= base.sum;
+        return *this;
+    }
+
+    StatsSnapshot& StatsSnapshot::operator-=(const StatsSnapshot& base) {
+        totals.packets_sent -= base.totals.packets_sent;
+        totals.busy_events -= base.totals.busy_events;
+        totals.collisions -= base.totals.collisions;
+        totals.jam_sent -= base.totals.jam_sent;
+        totals.total_attempts -= base.totals.total_attempts;
+        totals.retransmissions -= base.totals.retransmissions;
+        totals.frames_received -= base.totals.frames_received;
+        totals.uncorrectable_frames -= base.totals.uncorrectable_frames;
+        totals.queue_overflows -= base.totals.queue_overflows;
+        eccClean -= base.eccClean;
+        eccCorrected -= base.eccCorrected;
+        accessDelayUs -= base.accessDelayUs;
+        backoffDelayUs -= base.backoffDelayUs;
+        attemptsPerFrame -= base.attemptsPerFrame;
+        frameLatencyUs -= base.frameLatencyUs;
+        return *this;
+    }
+
+    // --- StatsRecorder ---
+
+    // Осколков не больше, чем потоков в системе: линии обычно пишет один-два потока
+    StatsRecorder::StatsRecorder() {
+        unsigned count = std::bit_ceil(std::clamp(std::thread::hardware_concurrency(), 1u, MAX_SHARDS));
+        shardMask = count - 1;
+        shards = std::make_unique<Shard[]>(count);
+        for (unsigned s = 0; s < count; ++s) {
+            for (auto& c : shards[s].counters) c.store(0, std::memory_order_relaxed);
+            for (auto& c : shards[s].sums) c.store(0, std::memory_order_relaxed);
+            for (auto& h : shards[s].buckets) {
+                for (auto& b : h) b.store(0, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    StatsRecorder::Shard& StatsRecorder::local() {
+        return shards[thread_slot() & shardMask];
+    }
+
+    void StatsRecorder::add(Counter counter, uint64_t n) {
+        local().counters[static_cast<int>(counter)].fetch_add(n, std::memory_order_relaxed);
+    }
+
+    void StatsRecorder::record(Histogram histogram, uint64_t value) {
+        Shard& shard = local();
+        int h = static_cast<int>(histogram);
+        shard.buckets[h][HistogramSnapshot::bucketOf(value)].fetch_add(1, std::memory_order_relaxed);
+        shard.sums[h].fetch_add(value, std::memory_order_relaxed);
+    }
+
+    uint64_t StatsRecorder::count(Counter counter) const {
+        uint64_t total = 0;
+        for (unsigned s = 0; s <= shardMask; ++s) {
+            total += shards[s].counters[static_cast<int>(counter)].load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+
+    StatsSnapshot StatsRecorder::snapshot() const {
+        uint64_t counters[COUNTERS] = {};
+        HistogramSnapshot histograms[HISTOGRAMS];
+
+        for (unsigned s = 0; s <= shardMask; ++s) {
+            const Shard& shard = shards[s];
+            for (int c = 0; c < COUNTERS; ++c) {
+                counters[c] += shard.counters[c].load(std::memory_order_relaxed);
+            }
+            for (int h = 0; h < HISTOGRAMS; ++h) {
+                histograms[h].sum += shard.sums[h].load(std::memory_order_relaxed);
+                for (int b = 0; b < HistogramSnapshot::BUCKETS; ++b) {
+                    uint64_t n = shard.buckets[h][b].load(std::memory_order_relaxed);
+                    histograms[h].buckets[b] += n;
+                    histograms[h].count += n;
+                }
+            }
+        }
+
+        auto value = [&counters](Counter c) { return static_cast<int>(counters[static_cast<int>(c)]); };
+
+        StatsSnapshot snap;
+        snap.totals.packets_sent = value(Counter::PacketsSent);
+        snap.totals.busy_events = value(Counter::BusyEvents);
+        snap.totals.collisions = value(Counter::Collisions);
+        snap.totals.jam_sent = value(Counter::JamSent);
+        snap.totals.total_attempts = value(Counter::TotalAttempts);
+        snap.totals.retransmissions = value(Counter::Retransmissions);
+        snap.totals.frames_received = value(Counter::FramesReceived);
+        snap.totals.uncorrectable_frames = value(Counter::Uncorrectable);
+        snap.totals.queue_overflows = value(Counter::QueueOverflows);
+        snap.eccClean = counters[static_cast<int>(Counter::EccClean)];
+        snap.eccCorrected = counters[static_cast<int>(Counter::EccCorrected)];
+        snap.accessDelayUs = histograms[static_cast<int>(Histogram::AccessDelay)];
+        snap.backoffDelayUs = histograms[static_cast<int>(Histogram::BackoffDelay)];
+        snap.attemptsPerFrame = histograms[static_cast<int>(Histogram::Attempts)];
+        snap.frameLatencyUs = histograms[static_cast<int>(Histogram::FrameLatency)];
+        return snap;
+    }
+}
@@ -0,0 +1,112 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include "CsmaConfig.h"
+
+namespace CSMA {
+    // - :   SUB_BUCKETS  ,
+    //    [2^e, 2^(e+1))   SUB_BUCKETS  ,
+    //        1/16  .   2^MAX_BITS
+    //    .    
+    struct HistogramSnapshot {
+        static const int SUB_BITS = 4;
+        static const int SUB_BUCKETS = 1 << SUB_BITS;
+        static const int MAX_BITS = 40;
+        static const int BUCKETS = SUB_BUCKETS * (MAX_BITS - SUB_BITS + 1);
+
+        std::array<uint64_t, BUCKETS> buckets{};
+        uint64_t count = 0;
+        uint64_t sum = 0;
+
+        static int bucketOf(uint64_t value);
+        static uint64_t bucketLowerBound(int bucket);
+        static uint64_t bucketUpperBound(int bucket);
+
+        double mean() const { return count > 0 ? static_cast<double>(sum) / count : 0.0; }
+        // p  0  1; 0   
+        uint64_t percentile(double p) const;
+        //     
+        uint64_t max() const;
+
+        HistogramSnapshot& operator+=(const HistogramSnapshot& other);
+        HistogramSnapshot& operator-=(const HistogramSnapshot& base);
+    };
+
+    //      
+    struct StatsSnapshot {
+        Stats totals;
+        uint64_t eccClean = 0;          //    
+        uint64_t eccCorrected = 0;      //   ;   totals.uncorrectable_frames
+        HistogramSnapshot accessDelayUs;    //       
+        HistogramSnapshot backoffDelayUs;   //   
+        HistogramSnapshot attemptsPerFrame; //   ,   
+        HistogramSnapshot frameLatencyUs;   //       
+
+        //   ,  :   
+        StatsSnapshot& operator-=(const StatsSnapshot& base);
+    };
+
+    //      .    
+    //  (    ),   relaxed fetch_add
+    //    ; snapshot()  .
+    class StatsRecorder {
+    public:
+        enum class Counter {
+            PacketsSent,
+            BusyEvents,
+            Collisions,
+            JamSent,
+            TotalAttempts,
+            Retransmissions,
+            FramesReceived,
+            EccClean,
+            EccCorrected,
+            Uncorrectable,
+            QueueOverflows,
+            COUNT
+        };
+
+        enum class Histogram {
+            AccessDelay,
+            BackoffDelay,
+            Attempts,
+            FrameLatency,
+            COUNT
+        };
+
+        StatsRecorder();
+
+        StatsRecorder(const StatsRecorder&) = delete;
+        StatsRecorder& operator=(const StatsRecorder&) = delete;
+
+        void add(Counter counter, uint64_t n = 1);
+        void record(Histogram histogram, uint64_t value);
+        void recordDuration(Histogram histogram, std::chrono::steady_clock::duration d) {
+            auto us = std::chrono::duration_cast<std::chrono::microseconds>(d).count();
+            record(histogram, us > 0 ? static_cast<uint64_t>(us) : 0);
+        }
+
+        //      
+        uint64_t count(Counter counter) const;
+
+        StatsSnapshot snapshot() const;
+
+    private:
+        static const int COUNTERS = static_cast<int>(Counter::COUNT);
+        static const int HISTOGRAMS = static_cast<int>(Histogram::COUNT);
+
+        struct alignas(64) Shard {
+            std::atomic<uint64_t> counters[COUNTERS];
+            std::atomic<uint64_t> sums[HISTOGRAMS];
+            std::atomic<uint64_t> buckets[HISTOGRAMS][HistogramSnapshot::BUCKETS];
+        };
+
+        unsigned shardMask = 0;
+        std::unique_ptr<Shard[]> shards;
+
+        Shard& local();
+    };
+}
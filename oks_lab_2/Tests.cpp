@@ -0,0 +1,653 @@
+﻿#include "Arq.h"
+#include "AsyncLink.h"
+#include "ByteStuffing.h"
+#include "ChannelNoise.h"
+#include "CompactHeader.h"
+#include "Crc32c.h"
+#include "CsmaConfig.h"
+#include "Frame.h"
+#include "FrameParser.h"
+#include "HammingBlock.h"
+#include "LineReceiver.h"
+#include "Lz.h"
+#include "PtyTransport.h"
+#include "StatsRecorder.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+// Проверки ядра протокола без портов и потоков.
+// oks_tests [--filter имя]; код возврата 0 — все проверки прошли
+
+namespace {
+    int failures = 0;
+
+    void expect(bool ok, const std::string& what) {
+        if (ok) return;
+        failures++;
+        std::cerr << "  FAIL: " << what << std::endl;
+    }
+
+    std::vector<uint8_t> random_bytes(size_t size, std::mt19937& rng) {
+        std::vector<uint8_t> out(size);
+        for (auto& b : out) b = static_cast<uint8_t>(rng());
+        return out;
+    }
+
+    // --- Lz ---
+
+    void test_lz_roundtrip() {
+        std::mt19937 rng(1);
+        std::vector<std::string> inputs;
+        inputs.push_back(std::string(5000, 'a'));
+        std::string text;
+        while (text.size() < 20000) text += "кадр канал коллизия frame ACK CSMA/CD " + std::to_string(rng() % 50) + "\n";
+        inputs.push_back(text);
+        auto noise = random_bytes(3000, rng);
+        inputs.push_back(std::string(noise.begin(), noise.end()));
+        // Совпадения на границе окна 64 КБ
+        std::string far(70000, '\0');
+        for (size_t i = 0; i < far.size(); ++i) far[i] = static_cast<char>((i * 7 / 3) % 251);
+        inputs.push_back(far);
+
+        for (const std::string& in : inputs) {
+            std::span<const uint8_t> bytes(reinterpret_cast<const uint8_t*>(in.data()), in.size());
+            std::string packed;
+            if (!Lz::compress(bytes, packed)) {
+                expect(in.size() == noise.size(), "lz: сжимаемые данные не сжались, " + std::to_string(in.size()) + " байт");
+                continue;
+            }
+            expect(packed.size() < in.size(), "lz: блок не короче исходных");
+
+            // Два блока подряд разбираются по очереди
+            std::string stream = packed + packed;
+            std::string out;
+            std::span<const uint8_t> s(reinterpret_cast<const uint8_t*>(stream.data()), stream.size());
+            size_t first = Lz::decompress(s, out);
+            size_t second = first ? Lz::decompress(s.subspan(first), out) : 0;
+            expect(first == packed.size() && second == packed.size(), "lz: длина блока");
+            expect(out == in + in, "lz: данные после распаковки, " + std::to_string(in.size()) + " байт");
+
+            // Оборванный блок не разбирается и не портит out
+            std::string partial;
+            expect(Lz::decompress(s.first(packed.size() - 1), partial) == 0 && partial.empty(), "lz: оборванный блок");
+        }
+    }
+
+    // --- Байт-стаффинг ---
+
+    void test_stuffing_roundtrip() {
+        std::mt19937 rng(2);
+        const uint8_t special[] = { ByteStuffing::START_FLAG, ByteStuffing::ESC, ByteStuffing::END_FLAG };
+        for (size_t size = 0; size <= 300; ++size) {
+            // Служебные байты гуще, чем в случайных данных: проверяются и векторные ядра
+            std::vector<uint8_t> in = random_bytes(size, rng);
+            for (auto& b : in) if (rng() % 3 == 0) b = special[rng() % 3];
+
+            std::vector<uint8_t> stuffed(ByteStuffing::max_stuffed_size(size) + 1);
+            size_t n = ByteStuffing::stuff(in, stuffed.data());
+            bool clean = std::none_of(stuffed.begin(), stuffed.begin() + n, [](uint8_t b) {
+                return b == ByteStuffing::START_FLAG || b == ByteStuffing::END_FLAG;
+            });
+            expect(clean, "stuffing: флаг в данных, " + std::to_string(size) + " байт");
+            stuffed[n++] = ByteStuffing::END_FLAG;
+
+            std::vector<uint8_t> out(n);
+            size_t written = 0;
+            bool ok = ByteStuffing::unstuff(std::span<const uint8_t>(stuffed.data(), n), out.data(), written);
+            out.resize(written);
+            expect(ok && out == in, "stuffing: данные после снятия, " + std::to_string(size) + " байт");
+        }
+    }
+
+    // --- CRC-32C ---
+
+    uint32_t crc32c_bitwise(std::span<const uint8_t> data) {
+        uint32_t crc = 0xFFFFFFFF;
+        for (uint8_t b : data) {
+            crc ^= b;
+            for (int k = 0; k < 8; ++k) crc = (crc >> 1) ^ (0x82F63B78 & (0u - (crc & 1)));
+        }
+        return ~crc;
+    }
+
+    void test_crc32c_vectors() {
+        // RFC 3720, приложение B.4, и стандартная строка "123456789"
+        const char* check = "123456789";
+        expect(Crc32c::compute(std::span<const uint8_t>(reinterpret_cast<const uint8_t*>(check), 9)) == 0xE3069283,
+               "crc32c: \"123456789\"");
+
+        std::vector<uint8_t> buf(32, 0x00);
+        expect(Crc32c::compute(buf) == 0x8A9136AA, "crc32c: 32 нулевых байта");
+        std::fill(buf.begin(), buf.end(), 0xFF);
+        expect(Crc32c::compute(buf) == 0x62A8AB43, "crc32c: 32 байта 0xFF");
+        for (size_t i = 0; i < buf.size(); ++i) buf[i] = static_cast<uint8_t>(i);
+        expect(Crc32c::compute(buf) == 0x46DD794E, "crc32c: 0..31");
+        for (size_t i = 0; i < buf.size(); ++i) buf[i] = static_cast<uint8_t>(31 - i);
+        expect(Crc32c::compute(buf) == 0x113FDB5C, "crc32c: 31..0");
+
+        // Длинные данные идут через трехпоточное ядро, невыровненное начало и хвосты
+        std::mt19937 rng(3);
+        for (size_t size : { 1, 7, 8, 255, 256, 1000, 4096, 12345, 65535 }) {
+            std::vector<uint8_t> data = random_bytes(size + 3, rng);
+            std::span<const uint8_t> s(data.data() + 3, size);
+            uint32_t expected = crc32c_bitwise(s);
+            expect(Crc32c::compute(s) == expected, "crc32c: " + std::to_string(size) + " байт");
+            size_t half = size / 2;
+            expect(Crc32c::update(Crc32c::compute(s.first(half)), s.subspan(half)) == expected,
+                   "crc32c: продолжение, " + std::to_string(size) + " байт");
+        }
+    }
+
+    // --- SECDED ---
+
+    void flip(std::vector<uint8_t>& data, size_t bit) {
+        data[bit / 8] ^= static_cast<uint8_t>(1u << (bit % 8));
+    }
+
+    void test_secded_classification() {
+        std::mt19937 rng(4);
+        for (FecMode mode : { FecMode::Whole, FecMode::Blocked, FecMode::Interleaved }) {
+            std::string name = HammingBlock::mode_name(mode);
+            for (size_t size : { 1, 8, 32, 100, 200 }) {
+                std::vector<uint8_t> data = random_bytes(size, rng);
+                std::vector<uint8_t> fcs(HammingBlock::fcs_size(size, mode));
+                HammingBlock::generate_fcs_into(data, fcs, mode);
+                std::string where = name + ", " + std::to_string(size) + " байт";
+
+                expect(HammingBlock::check(data, fcs, mode) == HammingStatus::Clean, "secded: чистый кадр, " + where);
+
+                // Любая одиночная ошибка исправляется
+                int wrong = 0;
+                for (size_t bit = 0; bit < size * 8; ++bit) {
+                    std::vector<uint8_t> copy = data;
+                    flip(copy, bit);
+                    if (HammingBlock::correct_in_place(copy, fcs, mode) != HammingStatus::SingleCorrected || copy != data) wrong++;
+                }
+                expect(wrong == 0, "secded: одиночные ошибки, " + where);
+
+                // Две ошибки в одном коде (72,64) обнаруживаются и не "исправляются".
+                // Blocked: биты одного восьмибайтового блока; Interleaved: бит с тем же
+                // номером в другом байте той же группы из 64 байт
+                wrong = 0;
+                for (int trial = 0; trial < 500; ++trial) {
+                    size_t a = rng() % (size * 8);
+                    size_t b = rng() % (size * 8);
+                    if (mode == FecMode::Blocked) b = (a / 64) * 64 + b % std::min<size_t>(64, size * 8 - (a / 64) * 64);
+                    if (mode == FecMode::Interleaved) {
+                        size_t group = a / 8 / HammingBlock::FEC_GROUP_BYTES * HammingBlock::FEC_GROUP_BYTES;
+                        size_t bytes = std::min(HammingBlock::FEC_GROUP_BYTES, size - group);
+                        b = (group + b % bytes) * 8 + a % 8;
+                    }
+                    if (a == b) continue;
+                    std::vector<uint8_t> copy = data;
+                    flip(copy, a);
+                    flip(copy, b);
+                    if (HammingBlock::check(copy, fcs, mode) != HammingStatus::DoubleDetected) wrong++;
+                }
+                expect(wrong == 0, "secded: двойные ошибки, " + where + ", неверно " + std::to_string(wrong));
+            }
+        }
+    }
+
+    // --- Сжатый заголовок ---
+
+    Frame make_frame(uint8_t seq, uint64_t timestamp, size_t len) {
+        Frame frame;
+        frame.sender = 3;
+        frame.receiver = 4;
+        frame.timestamp = timestamp;
+        frame.seqNumber = seq;
+        frame.dataLen = static_cast<uint16_t>(len);
+        frame.setCrc(true);
+        frame.setCompactHeader(true);
+        std::vector<uint8_t> data(len);
+        for (size_t i = 0; i < len; ++i) data[i] = static_cast<uint8_t>(seq + i);
+        frame.data.assign(std::span<const uint8_t>(data));
+        return frame;
+    }
+
+    std::vector<uint8_t> encode(const Frame& frame, CompactHeader::Encoder& headers) {
+        std::vector<uint8_t> raw(Frame::max_encoded_size(frame.data.size()));
+        raw.resize(frame.encode_into(raw, &headers));
+        return raw;
+    }
+
+    bool same_fields(const Frame& a, const Frame& b) {
+        return a.sender == b.sender && a.receiver == b.receiver && a.timestamp == b.timestamp &&
+            a.seqNumber == b.seqNumber && a.dataLen == b.dataLen &&
+            a.data.size() == b.data.size() && std::equal(a.data.begin(), a.data.end(), b.data.begin());
+    }
+
+    void test_compact_header_lost_reference() {
+        const int FRAMES = 3 * static_cast<int>(CompactHeader::REFRESH_FRAMES);
+        std::vector<Frame> sent;
+        std::vector<std::vector<uint8_t>> raws;
+        CompactHeader::Encoder headers;
+        for (int i = 0; i < FRAMES; ++i) {
+            sent.push_back(make_frame(static_cast<uint8_t>(i), 1700000000000ULL + i * 3, 20 + i % 7));
+            raws.push_back(encode(sent.back(), headers));
+        }
+
+        std::vector<Frame> got;
+        FrameParser parser([&got](Frame& f) { got.push_back(std::move(f)); });
+
+        // Без потерь — все поля на месте
+        for (const auto& raw : raws) parser.feed(raw);
+        expect(got.size() == sent.size(), "compact: кадры без потерь");
+        for (size_t i = 0; i < std::min(got.size(), sent.size()); ++i) {
+            expect(same_fields(got[i], sent[i]), "compact: поля кадра " + std::to_string(i));
+        }
+
+        // Теряется второй опорный кадр: его зависимые отбрасываются целиком,
+        // после следующего опорного прием восстанавливается
+        const size_t lost = CompactHeader::REFRESH_FRAMES + 1;
+        got.clear();
+        FrameParser fresh([&got](Frame& f) { got.push_back(std::move(f)); });
+        for (size_t i = 0; i < raws.size(); ++i) {
+            if (i != lost) fresh.feed(raws[i]);
+        }
+        for (const Frame& f : got) {
+            auto it = std::find_if(sent.begin(), sent.end(), [&f](const Frame& s) { return s.seqNumber == f.seqNumber; });
+            expect(it != sent.end() && same_fields(f, *it), "compact: чужие поля у кадра " + std::to_string(f.seqNumber));
+            size_t index = it - sent.begin();
+            expect(index < lost || index >= 2 * lost, "compact: принят зависимый кадр потерянного опорного");
+        }
+        expect(got.size() == raws.size() - lost, "compact: кадры после потери опорного");
+
+        // После reset кодировщика следующий кадр опорный: потеря предыдущего
+        // кадра не затрагивает следующее сообщение
+        CompactHeader::Encoder tx;
+        encode(sent[0], tx);                // ушел в линию неудачно
+        tx.reset();
+        got.clear();
+        FrameParser rx([&got](Frame& f) { got.push_back(std::move(f)); });
+        for (int i = 1; i < 4; ++i) rx.feed(encode(sent[i], tx));
+        expect(got.size() == 3, "compact: кадры после сброса кодировщика");
+    }
+
+    // --- Параметры CSMA ---
+
+    void test_csma_params() {
+        CSMA::Params params;
+        expect(!CSMA::set_param(params, "persistence", "0") && params.persistence == 0.5, "csma: persistence 0 отклонена");
+        expect(!CSMA::set_param(params, "persistence", "1.5"), "csma: persistence больше 1 отклонена");
+        expect(CSMA::set_param(params, "persistence", "0.01") && params.persistence == 0.01, "csma: persistence 0.01");
+        expect(CSMA::set_param(params, "persistence", "1") && params.persistence == 1.0, "csma: persistence 1");
+        expect(CSMA::set_param(params, "prob_collision", "0") && params.probCollision == 0.0, "csma: prob_collision 0");
+    }
+
+    // --- Модели шума ---
+
+    void test_channel_noise_ber() {
+        ChannelNoise::Model model;
+        expect(ChannelNoise::Model::parse("ber:0.01", model) && model.ber == 0.01, "noise: ber:0.01");
+        expect(ChannelNoise::Model::parse("ber:0", model) && model.ber == 0.0, "noise: ber:0");
+        expect(!ChannelNoise::Model::parse("ber:1", model), "noise: ber:1 отклонена");
+        expect(!ChannelNoise::Model::parse("ber:1.5", model), "noise: ber:1.5 отклонена");
+        expect(!ChannelNoise::Model::parse("ber:-0.1", model), "noise: отрицательная ber отклонена");
+
+        std::mt19937 rng(6);
+        std::vector<uint8_t> data(1000, 0x5A);
+        size_t flipped = ChannelNoise::Model::bernoulli(0.1).apply(data, rng);
+        expect(flipped > 700 && flipped < 900, "noise: ber 0.1 на 8000 битах, " + std::to_string(flipped));
+        std::vector<uint8_t> all(16, 0x5A);
+        expect(ChannelNoise::Model::bernoulli(1.0).apply(all, rng) == 128 &&
+               std::all_of(all.begin(), all.end(), [](uint8_t b) { return b == 0xA5; }), "noise: ber 1");
+    }
+
+    // --- Прием линии ---
+
+    void test_line_receiver_chunks() {
+        std::mt19937 rng(5);
+        std::vector<uint8_t> stream;
+        std::vector<Frame> sent;
+        for (int i = 0; i < 20; ++i) {
+            // Кадры с флагами и ESC в данных, вперемешку с ENQ
+            Frame frame = make_frame(static_cast<uint8_t>(i), 1000 + i, 1 + rng() % 300);
+            std::vector<uint8_t> data(frame.data.begin(), frame.data.end());
+            for (auto& b : data) if (rng() % 4 == 0) b = ByteStuffing::ESC;
+            frame.data.assign(std::span<const uint8_t>(data));
+            frame.setCompactHeader(false);
+            sent.push_back(frame);
+            stream.push_back(CSMA::ENQ);
+            std::vector<uint8_t> raw = frame.create_frame();
+            stream.insert(stream.end(), raw.begin(), raw.end());
+        }
+
+        CSMA::Params params;
+        params.probChannelBusy = 0.0;
+        params.probCollision = 0.0;
+        std::vector<Frame> got;
+        int acks = 0;
+        LineReceiver clean(params, 1);
+        clean.setFrameHandler([&got](Frame& f) { got.push_back(std::move(f)); });
+        clean.setReply([&acks](uint8_t b) { if (b == CSMA::ACK) acks++; });
+        for (size_t i = 0; i < stream.size(); ) {
+            size_t n = std::min<size_t>(1 + rng() % 97, stream.size() - i);
+            clean.feed(std::span<const uint8_t>(stream.data() + i, n));
+            i += n;
+        }
+        expect(acks == static_cast<int>(sent.size()), "line: ответы на ENQ");
+        expect(got.size() == sent.size(), "line: кадры без коллизий");
+        for (size_t i = 0; i < std::min(got.size(), sent.size()); ++i) {
+            expect(same_fields(got[i], sent[i]), "line: поля кадра " + std::to_string(i));
+        }
+
+        // Коллизия на каждом байте: ни один кадр не проходит
+        params.probCollision = 1.0;
+        got.clear();
+        int cols = 0;
+        LineReceiver noisy(params, 2);
+        noisy.setFrameHandler([&got](Frame& f) { got.push_back(std::move(f)); });
+        noisy.setReply([&cols](uint8_t b) { if (b == CSMA::COL) cols++; });
+        noisy.feed(stream);
+        // Кадр так и не начинается, поэтому управляющими считаются все ENQ и JAM потока
+        auto control = std::count_if(stream.begin(), stream.end(), [](uint8_t b) { return b == CSMA::ENQ || b == CSMA::JAM; });
+        expect(got.empty() && cols == static_cast<int>(stream.size() - control), "line: коллизия на каждом байте");
+
+        // Доля байтов с коллизией совпадает с вероятностью
+        params.probCollision = 0.01;
+        cols = 0;
+        LineReceiver sampled(params, 3);
+        sampled.setReply([&cols](uint8_t b) { if (b == CSMA::COL) cols++; });
+        std::vector<uint8_t> filler(200000, 0x41);
+        sampled.feed(filler);
+        expect(cols > 1800 && cols < 2200, "line: частота коллизий " + std::to_string(cols));
+    }
+
+    // --- Гистограммы задержек ---
+
+    void test_histogram_percentiles() {
+        // Границы корзин сходятся и покрывают все значения
+        using H = CSMA::HistogramSnapshot;
+        for (int b = 1; b < H::BUCKETS; ++b) {
+            expect(H::bucketLowerBound(b) == H::bucketUpperBound(b - 1) + 1, "histogram: граница корзины " + std::to_string(b));
+        }
+        for (uint64_t v : { 0ULL, 1ULL, 15ULL, 16ULL, 17ULL, 1000ULL, 1234567ULL, (1ULL << 40) - 1 }) {
+            int b = H::bucketOf(v);
+            expect(H::bucketLowerBound(b) <= v && v <= H::bucketUpperBound(b), "histogram: корзина значения " + std::to_string(v));
+        }
+
+        // Равномерные задержки 1..1000 мс в мкс: процентили с точностью до ширины корзины
+        CSMA::StatsRecorder stats;
+        for (uint64_t ms = 1; ms <= 1000; ++ms) {
+            stats.record(CSMA::StatsRecorder::Histogram::FrameLatency, ms * 1000);
+        }
+        H h = stats.snapshot().frameLatencyUs;
+        auto near = [](uint64_t got, double want) { return got >= want * 0.97 && got <= want * 1.03; };
+        expect(near(h.percentile(0.5), 500500.0), "histogram: p50 " + std::to_string(h.percentile(0.5)));
+        expect(near(h.percentile(0.99), 990010.0), "histogram: p99 " + std::to_string(h.percentile(0.99)));
+        expect(h.max() >= 1000000 && h.max() <= 1000000 * 1.07, "histogram: max " + std::to_string(h.max()));
+
+        // Одно значение: процентиль не выходит за его корзину
+        CSMA::StatsRecorder single;
+        single.record(CSMA::StatsRecorder::Histogram::FrameLatency, 1060000);
+        H one = single.snapshot().frameLatencyUs;
+        expect(near(one.percentile(0.5), 1060000.0) && one.percentile(0.99) <= one.max(), "histogram: одно значение");
+    }
+
+    // --- ARQ ---
+
+    // Модель: кадр занимает линию frameTime, кадр данных и подтверждение
+    // теряются независимо с вероятностью loss, очередь приема отказывает
+    // в кадре с вероятностью refuse. Цикл повторяет sendReliable.
+    bool run_arq(ARQ::Mode mode, int window, int frames, double loss, double refuse, unsigned seed, std::string& why) {
+        using namespace std::chrono;
+        const auto frameTime = milliseconds(10);
+        const auto timeout = milliseconds(50);
+
+        std::mt19937 rng(seed);
+        std::bernoulli_distribution lost(loss);
+        std::bernoulli_distribution full(refuse);
+        ARQ::Clock::time_point now{};
+
+        ARQ::Sender sender;
+        auto receiver = std::make_unique<ARQ::Receiver>();
+        receiver->reset(ARQ::Mode::Off, 1, 0);
+        const uint8_t firstSeq = 200;   // окно переходит через 255
+        sender.reset(mode, window, firstSeq, timeout);
+        uint64_t session = sender.openSession(1000);
+
+        std::vector<int> delivered;
+        auto deliver = [&](Frame& f) {
+            if (full(rng)) return false;
+            if (f.dataLen > 0) delivered.push_back(f.data[0] | (f.data[1] << 8));
+            return true;
+        };
+
+        std::array<int, 256> payloadOf{};
+        bool ackPending = false;
+        ARQ::Ack ack;
+        auto transmit = [&](uint8_t seq) {
+            now += frameTime;
+            ackPending = false;
+            if (lost(rng)) return;
+            Frame frame{};
+            frame.seqNumber = seq;
+            if (payloadOf[seq] < 0) {
+                frame.dataLen = 0;
+                receiver->sync(seq, session, mode, window, deliver);
+            }
+            else {
+                uint8_t data[2] = { static_cast<uint8_t>(payloadOf[seq]), static_cast<uint8_t>(payloadOf[seq] >> 8) };
+                frame.dataLen = 2;
+                frame.data.assign(std::span<const uint8_t>(data));
+                receiver->accept(std::move(frame), deliver);
+            }
+            ack = receiver->ack();
+            ackPending = receiver->inSession() && !lost(rng);
+        };
+        // Подтверждение приходит, пока передатчик уже учел кадр
+        auto applyAck = [&]() {
+            if (ackPending) sender.onAck(ack);
+            ackPending = false;
+        };
+
+        bool syncPending = true;
+        int sent = 0;
+        std::vector<uint8_t> due;
+        while (syncPending || sent < frames || !sender.allAcked()) {
+            while (sender.canSend() && (syncPending || sent < frames)) {
+                uint8_t seq = sender.nextSeq();
+                payloadOf[seq] = syncPending ? -1 : sent++;
+                syncPending = false;
+                transmit(seq);
+                sender.onSent(now);
+                applyAck();
+            }
+            if (!sender.allAcked() && !(sender.canSend() && sent < frames)) {
+                now = std::max(now, sender.nextDeadline());
+            }
+
+            sender.dueRetransmissions(now, due);
+            for (uint8_t seq : due) {
+                if (!sender.isPending(seq)) continue;
+                if (!sender.retriesLeft(seq)) {
+                    why = "кадр " + std::to_string(payloadOf[seq]) + " исчерпал повторы";
+                    return false;
+                }
+                transmit(seq);
+                sender.onRetransmitted(seq, now);
+                applyAck();
+            }
+            if (!due.empty()) sender.onGoBackSent(now);
+        }
+
+        for (int i = 0; i < frames; ++i) {
+            if (i >= static_cast<int>(delivered.size()) || delivered[i] != i) {
+                why = "нарушен порядок или пропуск у кадра " + std::to_string(i);
+                return false;
+            }
+        }
+        if (static_cast<int>(delivered.size()) != frames) {
+            why = "доставлено " + std::to_string(delivered.size()) + " из " + std::to_string(frames);
+            return false;
+        }
+        return true;
+    }
+
+    void test_arq_under_loss() {
+        struct Case { ARQ::Mode mode; int window; };
+        // Широкое окно Go-Back-N повторяется дольше тайм-аута одного кадра
+        const Case cases[] = {
+            { ARQ::Mode::GoBackN, 8 }, { ARQ::Mode::GoBackN, 100 }, { ARQ::Mode::GoBackN, 255 },
+            { ARQ::Mode::SelectiveRepeat, 8 }, { ARQ::Mode::SelectiveRepeat, 64 },
+        };
+        for (const Case& c : cases) {
+            for (double loss : { 0.0, 0.05, 0.2 }) {
+                for (unsigned seed = 1; seed <= 5; ++seed) {
+                    std::string why;
+                    bool ok = run_arq(c.mode, c.window, 600, loss, 0.0, seed, why);
+                    expect(ok, std::string("arq: ") + (c.mode == ARQ::Mode::GoBackN ? "GBN" : "SR") +
+                           " окно " + std::to_string(c.window) + ", потери " + std::to_string(loss) +
+                           ", seed " + std::to_string(seed) + ": " + why);
+                }
+            }
+        }
+    }
+
+    void test_arq_full_queue() {
+        // Кадр, не принятый очередью, не подтверждается и приходит повторно
+        for (ARQ::Mode mode : { ARQ::Mode::GoBackN, ARQ::Mode::SelectiveRepeat }) {
+            for (unsigned seed = 1; seed <= 5; ++seed) {
+                std::string why;
+                bool ok = run_arq(mode, 16, 600, 0.05, 0.2, seed, why);
+                expect(ok, std::string("arq: полная очередь, ") + (mode == ARQ::Mode::GoBackN ? "GBN" : "SR") +
+                       ", seed " + std::to_string(seed) + ": " + why);
+            }
+        }
+
+        // Отказ не сдвигает окно; следующий приход того же кадра доставляет
+        // и его, и накопленные за ним
+        auto receiver = std::make_unique<ARQ::Receiver>();
+        receiver->reset(ARQ::Mode::Off, 1, 0);
+        bool accepting = true;
+        std::vector<uint8_t> got;
+        auto deliver = [&](Frame& f) {
+            if (!accepting) return false;
+            got.push_back(f.seqNumber);
+            return true;
+        };
+        receiver->sync(0, 1, ARQ::Mode::SelectiveRepeat, 8, deliver);
+        Frame frame{};
+        frame.dataLen = 1;
+        accepting = false;
+        frame.seqNumber = 1;
+        receiver->accept(Frame(frame), deliver);
+        expect(receiver->ack().cumulative == 1, "arq: отказанный кадр не подтвержден");
+        frame.seqNumber = 2;
+        receiver->accept(Frame(frame), deliver);
+        expect(receiver->ack().cumulative == 1 && receiver->ack().selective == 1, "arq: следующий кадр в буфере");
+        accepting = true;
+        frame.seqNumber = 1;
+        receiver->accept(Frame(frame), deliver);
+        expect(receiver->ack().cumulative == 3 && got == std::vector<uint8_t>{ 1, 2 }, "arq: доставка после отказа");
+    }
+
+    void test_arq_sync_sessions() {
+        // Два сообщения в одну миллисекунду и часы, ушедшие назад
+        ARQ::Sender sender;
+        uint64_t a = sender.openSession(5000);
+        uint64_t b = sender.openSession(5000);
+        uint64_t c = sender.openSession(4000);
+        expect(a < b && b < c, "arq: номера сессий не повторяются");
+
+        // Новый SYNC с тем же seq после завершенной сессии подтверждается
+        auto receiver = std::make_unique<ARQ::Receiver>();
+        receiver->reset(ARQ::Mode::Off, 1, 0);
+        auto none = [](Frame&) { return true; };
+        receiver->sync(10, a, ARQ::Mode::SelectiveRepeat, 8, none);
+        expect(receiver->ack().cumulative == 11, "arq: SYNC открывает сессию");
+        receiver->sync(10, a, ARQ::Mode::SelectiveRepeat, 8, none);
+        expect(receiver->ack().cumulative == 11, "arq: повтор SYNC не сдвигает окно");
+        receiver->sync(11, b, ARQ::Mode::SelectiveRepeat, 8, none);
+        expect(receiver->ack().cumulative == 12, "arq: SYNC следующей сессии подтвержден");
+    }
+
+#ifdef __linux__
+    // --- Транспорт ---
+
+    void test_pty_baud_rates() {
+        // Скорость вне таблицы termios отклоняется и при открытии, и при смене
+        PtyTransport port;
+        expect(!port.open("PTY3100A", 12345) && !port.isOpen(), "pty: нестандартная скорость при открытии");
+        expect(port.open("PTY3100A", 9600), "pty: 9600 бод");
+        expect(!port.setBaudRate(12345) && port.setBaudRate(115200), "pty: смена скорости");
+    }
+
+    // --- Асинхронная линия ---
+
+    void test_async_link_completion_order() {
+        Reactor reactor;
+        CSMA::Params params;
+        params.probChannelBusy = 0.0;
+        params.probCollision = 0.0;
+        AsyncLink link(reactor, params, 1);
+        if (!link.open("LOOP3000A", "LOOP3000B", 115200)) {
+            expect(false, "async: линия не открылась");
+            return;
+        }
+
+        // Пустое сообщение за непустым завершается не раньше него
+        std::vector<int> order;
+        for (int i = 0; i < 4; ++i) {
+            std::string message = i % 2 ? std::string() : std::string(40, static_cast<char>('a' + i));
+            link.send(std::move(message), [&order, i](bool ok) { if (ok) order.push_back(i); });
+        }
+        auto deadline = Timing::Clock::now() + std::chrono::seconds(10);
+        while (order.size() < 4 && Timing::Clock::now() < deadline) reactor.runOnce(deadline);
+        expect(order == std::vector<int>{ 0, 1, 2, 3 }, "async: завершения в порядке send()");
+    }
+#endif
+
+    struct Test {
+        const char* name;
+        std::function<void()> run;
+    };
+}
+
+int main(int argc, char** argv) {
+    std::string filter;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--filter" && i + 1 < argc) filter = argv[++i];
+        else { std::cerr << "Неизвестный параметр " << arg << std::endl; return 2; }
+    }
+
+    const std::vector<Test> tests = {
+        { "lz_roundtrip", test_lz_roundtrip },
+        { "stuffing_roundtrip", test_stuffing_roundtrip },
+        { "crc32c_vectors", test_crc32c_vectors },
+        { "secded_classification", test_secded_classification },
+        { "compact_header_lost_reference", test_compact_header_lost_reference },
+        { "csma_params", test_csma_params },
+        { "channel_noise_ber", test_channel_noise_ber },
+        { "line_receiver_chunks", test_line_receiver_chunks },
+        { "histogram_percentiles", test_histogram_percentiles },
+        { "arq_under_loss", test_arq_under_loss },
+        { "arq_full_queue", test_arq_full_queue },
+        { "arq_sync_sessions", test_arq_sync_sessions },
+#ifdef __linux__
+        { "pty_baud_rates", test_pty_baud_rates },
+        { "async_link_completion_order", test_async_link_completion_order },
+#endif
+    };
+
+    int failedTests = 0;
+    for (const Test& t : tests) {
+        if (!filter.empty() && std::string(t.name).find(filter) == std::string::npos) continue;
+        int before = failures;
+        t.run();
+        bool ok = failures == before;
+        if (!ok) failedTests++;
+        std::cout << (ok ? "[ OK ] " : "[FAIL] ") << t.name << std::endl;
+    }
+    return failedTests == 0 ? 0 : 1;
+}
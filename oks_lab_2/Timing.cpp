@@ -0,0 +1,93 @@
+﻿#include "Timing.h"
+#include <algorithm>
+#include <thread>
+
+#ifdef _WIN32
+#include <windows.h>
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+#else
+#include <cerrno>
+#include <ctime>
+#endif
+
+namespace {
+#ifdef _WIN32
+    // Таймер высокого разрешения (Windows 10 1803+), один на поток
+    struct WaitableTimer {
+        HANDLE handle = CreateWaitableTimerExW(NULL, NULL, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+        ~WaitableTimer() {
+            if (handle) CloseHandle(handle);
+        }
+    };
+#elif defined(__linux__)
+    timespec to_timespec(Timing::Clock::duration d) {
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(d).count();
+        timespec ts;
+        ts.tv_sec = static_cast<time_t>(ns / 1000000000);
+        ts.tv_nsec = static_cast<long>(ns % 1000000000);
+        return ts;
+    }
+#endif
+}
+
+namespace Timing {
+
+    void sleep_until(Clock::time_point deadline) {
+#ifdef _WIN32
+        static thread_local WaitableTimer timer;
+        auto remaining = deadline - Clock::now();
+        if (remaining <= Clock::duration::zero()) return;
+        if (!timer.handle) {
+            std::this_thread::sleep_until(deadline);
+            return;
+        }
+        // Отрицательное значение — относительный срок в единицах по 100 нс
+        LARGE_INTEGER due;
+        due.QuadPart = -std::max<LONGLONG>(1, std::chrono::duration_cast<std::chrono::nanoseconds>(remaining).count() / 100);
+        if (SetWaitableTimer(timer.handle, &due, 0, NULL, NULL, FALSE)) {
+            WaitForSingleObject(timer.handle, INFINITE);
+        }
+        else {
+            std::this_thread::sleep_until(deadline);
+        }
+#elif defined(__linux__)
+        // steady_clock в Linux — это CLOCK_MONOTONIC
+        timespec ts = to_timespec(deadline.time_since_epoch());
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR) {
+        }
+#else
+        std::this_thread::sleep_until(deadline);
+#endif
+    }
+
+    int remaining_ms(Clock::time_point deadline, int cap) {
+        if (deadline == NO_DEADLINE) return cap;
+        auto remaining = deadline - Clock::now();
+        if (remaining <= Clock::duration::zero()) return 0;
+        auto ms = std::chrono::ceil<std::chrono::milliseconds>(remaining).count();
+        return static_cast<int>(std::min<long long>(ms, cap));
+    }
+
+#ifndef _WIN32
+    int poll_until(pollfd* fds, nfds_t count, Clock::time_point deadline) {
+        while (true) {
+            int ready;
+#ifdef __linux__
+            if (deadline == NO_DEADLINE) {
+                ready = ppoll(fds, count, nullptr, nullptr);
+            }
+            else {
+                timespec ts = to_timespec(std::max(deadline - Clock::now(), Clock::duration::zero()));
+                ready = ppoll(fds, count, &ts, nullptr);
+            }
+#else
+            ready = poll(fds, count, deadline == NO_DEADLINE ? -1 : remaining_ms(deadline, 1 << 30));
+#endif
+            if (ready >= 0 || errno != EINTR) return ready;
+        }
+    }
+#endif
+
+}
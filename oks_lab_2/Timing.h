@@ -0,0 +1,37 @@
+#pragma once
+#include <chrono>
+
+#ifndef _WIN32
+#include <poll.h>
+#endif
+
+//        .
+// ,   :     .
+namespace Timing {
+    using Clock = std::chrono::steady_clock;
+
+    //    (   interrupt())
+    constexpr Clock::time_point NO_DEADLINE = Clock::time_point::max();
+
+    //   deadline: clock_nanosleep(TIMER_ABSTIME)  Linux,
+    //     Windows  Sleep   ~15 
+    void sleep_until(Clock::time_point deadline);
+
+    inline void sleep_for(Clock::duration duration) {
+        sleep_until(Clock::now() + duration);
+    }
+
+    //   timeoutMs ;     
+    inline Clock::time_point deadline_after(int timeoutMs) {
+        return timeoutMs < 0 ? NO_DEADLINE : Clock::now() + std::chrono::milliseconds(timeoutMs);
+    }
+
+    //        ,   cap
+    int remaining_ms(Clock::time_point deadline, int cap);
+
+#ifndef _WIN32
+    // poll    (ppoll  Linux).    ,
+    // 0   ;   
+    int poll_until(pollfd* fds, nfds_t count, Clock::time_point deadline);
+#endif
+}
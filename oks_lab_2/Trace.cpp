@@ -0,0 +1,182 @@
+﻿#include "Trace.h"
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <utility>
+#include <vector>
+#include "HammingBlock.h"
+
+namespace Trace {
+
+    std::atomic<bool> active{ false };
+
+    namespace {
+        // Кольцо пишет только его поток; head растет монотонно,
+        // start сдвигает clear(), не трогая писателя
+        struct Ring {
+            std::unique_ptr<Record[]> slots = std::make_unique<Record[]>(RING_CAPACITY);
+            std::atomic<uint64_t> head{ 0 };
+            std::atomic<uint64_t> start{ 0 };
+            unsigned index = 0;
+        };
+
+        std::mutex registryMutex;
+
+        // Кольца живут до конца программы: потоки могут завершиться раньше выгрузки
+        std::vector<std::shared_ptr<Ring>>& registry() {
+            static std::vector<std::shared_ptr<Ring>> rings;
+            return rings;
+        }
+
+        Ring& local_ring() {
+            thread_local std::shared_ptr<Ring> ring = [] {
+                auto created = std::make_shared<Ring>();
+                std::lock_guard<std::mutex> lock(registryMutex);
+                created->index = static_cast<unsigned>(registry().size());
+                registry().push_back(created);
+                return created;
+            }();
+            return *ring;
+        }
+
+        uint64_t first_kept(const Ring& ring, uint64_t head) {
+            uint64_t oldest = head > RING_CAPACITY ? head - RING_CAPACITY : 0;
+            return std::max(oldest, ring.start.load(std::memory_order_relaxed));
+        }
+
+        const char* event_name(const Record& r) {
+            switch (r.event) {
+            case Event::EnqSent: return "ENQ";
+            case Event::AckReceived: return "ACK";
+            case Event::ChannelBusy: return "busy";
+            case Event::Collision: return "COL";
+            case Event::JamSent: return "JAM sent";
+            case Event::JamReceived: return "JAM received";
+            case Event::BackoffBegin:
+            case Event::BackoffEnd: return "backoff";
+            case Event::TxBegin:
+            case Event::TxEnd: return "tx";
+            case Event::FrameEnqueued: return "frame queued";
+            case Event::EccResult:
+                switch (static_cast<HammingStatus>(r.arg)) {
+                case HammingStatus::Clean: return "ECC clean";
+                case HammingStatus::SingleCorrected: return "ECC corrected";
+                default: return "ECC uncorrectable";
+                }
+            }
+            return "?";
+        }
+
+        // Интервалы — пары B/E, остальное — мгновенные события
+        const char* event_phase(Event e) {
+            switch (e) {
+            case Event::BackoffBegin:
+            case Event::TxBegin: return "B";
+            case Event::BackoffEnd:
+            case Event::TxEnd: return "E";
+            default: return "i";
+            }
+        }
+    }
+
+    void setEnabled(bool on) {
+        active.store(on, std::memory_order_release);
+    }
+
+    void write(Event event, uint16_t channel, uint32_t arg) {
+        Ring& ring = local_ring();
+        uint64_t head = ring.head.load(std::memory_order_relaxed);
+        Record& r = ring.slots[head & (RING_CAPACITY - 1)];
+        r.timeNs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+        r.arg = arg;
+        r.channel = channel;
+        r.event = event;
+        r.reserved = 0;
+        ring.head.store(head + 1, std::memory_order_release);
+    }
+
+    size_t recordCount() {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        size_t total = 0;
+        for (const auto& ring : registry()) {
+            uint64_t head = ring->head.load(std::memory_order_acquire);
+            total += static_cast<size_t>(head - first_kept(*ring, head));
+        }
+        return total;
+    }
+
+    void clear() {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        for (const auto& ring : registry()) {
+            ring->start.store(ring->head.load(std::memory_order_acquire), std::memory_order_relaxed);
+        }
+    }
+
+    // pid — поток, записавший событие, tid — линия: интервалы разных линий
+    // одного реактора не перемешиваются. Время в мкс от первой записи
+    bool exportChrome(const std::string& path) {
+        struct Copied {
+            unsigned thread;
+            Record record;
+        };
+        std::vector<Copied> records;
+        {
+            std::lock_guard<std::mutex> lock(registryMutex);
+            for (const auto& ring : registry()) {
+                uint64_t head = ring->head.load(std::memory_order_acquire);
+                for (uint64_t i = first_kept(*ring, head); i < head; ++i) {
+                    records.push_back({ ring->index, ring->slots[i & (RING_CAPACITY - 1)] });
+                }
+            }
+        }
+
+        std::ofstream out(path, std::ios::binary);
+        if (!out) return false;
+
+        uint64_t base = UINT64_MAX;
+        std::set<std::pair<unsigned, uint16_t>> tracks;
+        for (const Copied& c : records) {
+            base = std::min(base, c.record.timeNs);
+            tracks.insert({ c.thread, c.record.channel });
+        }
+
+        out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+        bool first = true;
+        auto separator = [&out, &first] {
+            if (!first) out << ",";
+            out << "\n";
+            first = false;
+        };
+
+        unsigned lastThread = UINT32_MAX;
+        for (const auto& [thread, channel] : tracks) {
+            if (thread != lastThread) {
+                separator();
+                out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << thread
+                    << ",\"args\":{\"name\":\"thread " << thread << "\"}}";
+                lastThread = thread;
+            }
+            separator();
+            out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << thread << ",\"tid\":" << channel
+                << ",\"args\":{\"name\":\"port " << channel << "\"}}";
+        }
+
+        out << std::fixed << std::setprecision(3);
+        for (const Copied& c : records) {
+            const Record& r = c.record;
+            const char* phase = event_phase(r.event);
+            separator();
+            out << "{\"name\":\"" << event_name(r) << "\",\"cat\":\"csma\",\"ph\":\"" << phase << "\""
+                << ",\"ts\":" << (r.timeNs - base) / 1000.0
+                << ",\"pid\":" << c.thread << ",\"tid\":" << r.channel;
+            if (phase[0] == 'i') out << ",\"s\":\"t\"";
+            out << ",\"args\":{\"arg\":" << r.arg << "}}";
+        }
+        out << "\n]}\n";
+        return static_cast<bool>(out);
+    }
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+//       .
+//     :       ,
+//     .   
+//  relaxed- .    JSON 
+// chrome://tracing  Perfetto.
+namespace Trace {
+    enum class Event : uint8_t {
+        EnqSent,        // arg   
+        AckReceived,
+        ChannelBusy,
+        Collision,
+        JamSent,
+        JamReceived,
+        BackoffBegin,   // arg  , 
+        BackoffEnd,
+        TxBegin,        // arg   
+        TxEnd,
+        FrameEnqueued,  // arg   
+        EccResult       // arg  HammingStatus
+    };
+
+    struct Record {
+        uint64_t timeNs;    // steady_clock
+        uint32_t arg;
+        uint16_t channel;   //    
+        Event event;
+        uint8_t reserved;
+    };
+    static_assert(sizeof(Record) == 16, "Trace::Record must stay 16 bytes");
+
+    //     
+    const size_t RING_CAPACITY = 1 << 16;
+
+    extern std::atomic<bool> active;
+
+    inline bool enabled() { return active.load(std::memory_order_relaxed); }
+    void setEnabled(bool on);
+
+    void write(Event event, uint16_t channel, uint32_t arg);
+
+    inline void emit(Event event, uint16_t channel = 0, uint32_t arg = 0) {
+        if (enabled()) write(event, channel, arg);
+    }
+
+    inline uint32_t micros(std::chrono::steady_clock::duration d) {
+        return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::microseconds>(d).count());
+    }
+
+    //      
+    size_t recordCount();
+    void clear();
+
+    //  trace JSON.    :
+    // ,    ,      
+    bool exportChrome(const std::string& path);
+}
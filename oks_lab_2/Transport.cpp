@@ -0,0 +1,39 @@
+﻿#include "Transport.h"
+#include "LoopbackTransport.h"
+#include "PtyTransport.h"
+#include "PosixSerialTransport.h"
+#include "Win32SerialTransport.h"
+#include <cctype>
+
+size_t Transport::receiveUntil(const ReceiveSink& sink, Timing::Clock::time_point deadline) {
+    uint8_t block[256];
+    size_t count = readUntil(block, deadline);
+    if (count > 0) {
+        sink(std::span<const uint8_t>(block, count));
+    }
+    return count;
+}
+
+uint8_t Transport::portNumber(const std::string& portName) {
+    uint8_t num = 0;
+    for (char c : portName) {
+        if (std::isdigit(static_cast<unsigned char>(c))) {
+            num = static_cast<uint8_t>(num * 10 + (c - '0'));
+        }
+    }
+    return num;
+}
+
+std::unique_ptr<Transport> Transport::create(const std::string& portName) {
+    if (portName.rfind("LOOP", 0) == 0) {
+        return std::make_unique<LoopbackTransport>();
+    }
+#ifdef _WIN32
+    return std::make_unique<Win32SerialTransport>();
+#else
+    if (portName.rfind("PTY", 0) == 0) {
+        return std::make_unique<PtyTransport>();
+    }
+    return std::make_unique<PosixSerialTransport>();
+#endif
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <span>
+#include <string>
+#include "Timing.h"
+
+//    . : COM- Win32,
+// termios (/dev/ttyS*, /dev/ttyUSB*),      .
+class Transport {
+public:
+    //      
+    using ReceiveSink = std::function<void(std::span<const uint8_t>)>;
+
+    virtual ~Transport() = default;
+
+    virtual bool open(const std::string& portName, uint32_t baudRate) = 0;
+    virtual void close() = 0;
+    virtual bool isOpen() const = 0;
+    virtual bool setBaudRate(uint32_t baudRate) = 0;
+
+    //  ,    
+    virtual size_t write(std::span<const uint8_t> data) = 0;
+
+    //   .   ,    deadline
+    // (Timing::NO_DEADLINE     interrupt()).
+    virtual size_t readUntil(std::span<uint8_t> buffer, Timing::Clock::time_point deadline) = 0;
+
+    //     sink.    .
+    //      ,    .
+    virtual size_t receiveUntil(const ReceiveSink& sink, Timing::Clock::time_point deadline);
+
+    //  ,   readUntil/receiveUntil;   0.
+    //      .
+    virtual void interrupt() = 0;
+
+    // ,        ( Reactor).
+    // -1      poll/epoll
+    virtual int readinessHandle() const { return -1; }
+
+    size_t read(std::span<uint8_t> buffer, int timeoutMs) {
+        return readUntil(buffer, Timing::deadline_after(timeoutMs));
+    }
+
+    size_t receive(const ReceiveSink& sink, int timeoutMs) {
+        return receiveUntil(sink, Timing::deadline_after(timeoutMs));
+    }
+
+    //   
+    virtual void purgeInput() = 0;
+
+    //     :
+    // LOOP<n>A/LOOP<n>B    , PTY<n>A/PTY<n>B   ,
+    //   COM- (Windows)   termios (/dev/...).
+    static std::unique_ptr<Transport> create(const std::string& portName);
+
+    //    :    (COM4 -> 4, LOOP12B -> 12)
+    static uint8_t portNumber(const std::string& portName);
+};
@@ -0,0 +1,96 @@
+﻿#include "Win32SerialTransport.h"
+
+#ifdef _WIN32
+
+Win32SerialTransport::~Win32SerialTransport() {
+    close();
+}
+
+bool Win32SerialTransport::open(const std::string& portName, uint32_t baudRate) {
+    close();
+
+    std::string fullPortName = "\\\\.\\" + portName;
+    hPort = CreateFileA(fullPortName.c_str(),
+        GENERIC_READ | GENERIC_WRITE,
+        0, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+
+    if (hPort == INVALID_HANDLE_VALUE) return false;
+
+    DCB dcbSerialParams = { 0 };
+    dcbSerialParams.DCBlength = sizeof(dcbSerialParams);
+    if (!GetCommState(hPort, &dcbSerialParams)) {
+        close();
+        return false;
+    }
+    dcbSerialParams.BaudRate = baudRate;
+    dcbSerialParams.ByteSize = 8;
+    dcbSerialParams.StopBits = ONESTOPBIT;
+    dcbSerialParams.Parity = NOPARITY;
+    if (!SetCommState(hPort, &dcbSerialParams)) {
+        close();
+        return false;
+    }
+
+    readTimeoutMs = -1;
+    setReadTimeout(10);
+    return true;
+}
+
+void Win32SerialTransport::close() {
+    if (hPort != INVALID_HANDLE_VALUE) {
+        CloseHandle(hPort);
+        hPort = INVALID_HANDLE_VALUE;
+    }
+}
+
+bool Win32SerialTransport::isOpen() const {
+    return hPort != INVALID_HANDLE_VALUE;
+}
+
+bool Win32SerialTransport::setBaudRate(uint32_t baudRate) {
+    DCB dcbSerialParams = { 0 };
+    dcbSerialParams.DCBlength = sizeof(dcbSerialParams);
+    if (!GetCommState(hPort, &dcbSerialParams)) return false;
+    dcbSerialParams.BaudRate = baudRate;
+    return SetCommState(hPort, &dcbSerialParams) != FALSE;
+}
+
+// Чтение возвращается сразу, как только пришел хотя бы один байт, иначе ждет до timeoutMs
+void Win32SerialTransport::setReadTimeout(int timeoutMs) {
+    if (timeoutMs == readTimeoutMs) return;
+
+    COMMTIMEOUTS timeouts = { 0 };
+    timeouts.ReadIntervalTimeout = MAXDWORD;
+    timeouts.ReadTotalTimeoutConstant = static_cast<DWORD>(timeoutMs);
+    timeouts.ReadTotalTimeoutMultiplier = timeoutMs > 0 ? MAXDWORD : 0;
+    timeouts.WriteTotalTimeoutConstant = 10;
+    timeouts.WriteTotalTimeoutMultiplier = 0;
+    SetCommTimeouts(hPort, &timeouts);
+    readTimeoutMs = timeoutMs;
+}
+
+size_t Win32SerialTransport::write(std::span<const uint8_t> data) {
+    DWORD bw = 0;
+    if (!WriteFile(hPort, data.data(), static_cast<DWORD>(data.size()), &bw, NULL)) return 0;
+    return bw;
+}
+
+size_t Win32SerialTransport::readUntil(std::span<uint8_t> buffer, Timing::Clock::time_point deadline) {
+    while (!interrupted.exchange(false)) {
+        setReadTimeout(Timing::remaining_ms(deadline, IDLE_WAIT_MS));
+        DWORD br = 0;
+        if (!ReadFile(hPort, buffer.data(), static_cast<DWORD>(buffer.size()), &br, NULL)) return 0;
+        if (br > 0 || Timing::Clock::now() >= deadline) return br;
+    }
+    return 0;
+}
+
+void Win32SerialTransport::interrupt() {
+    interrupted = true;
+}
+
+void Win32SerialTransport::purgeInput() {
+    PurgeComm(hPort, PURGE_RXCLEAR);
+}
+
+#endif
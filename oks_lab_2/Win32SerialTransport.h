@@ -0,0 +1,33 @@
+#pragma once
+#ifdef _WIN32
+#include <windows.h>
+#include <atomic>
+#include "Transport.h"
+
+// COM- Win32 (\\.\COMx)
+class Win32SerialTransport : public Transport {
+public:
+    ~Win32SerialTransport() override;
+
+    bool open(const std::string& portName, uint32_t baudRate) override;
+    void close() override;
+    bool isOpen() const override;
+    bool setBaudRate(uint32_t baudRate) override;
+
+    size_t write(std::span<const uint8_t> data) override;
+    size_t readUntil(std::span<uint8_t> buffer, Timing::Clock::time_point deadline) override;
+    void interrupt() override;
+    void purgeInput() override;
+
+private:
+    HANDLE hPort = INVALID_HANDLE_VALUE;
+    int readTimeoutMs = -1;
+    std::atomic<bool> interrupted{ false };
+
+    //  ReadFile     , 
+    //        
+    static const int IDLE_WAIT_MS = 100;
+
+    void setReadTimeout(int timeoutMs);
+};
+#endif
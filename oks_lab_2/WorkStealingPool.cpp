@@ -0,0 +1,99 @@
+﻿#include "WorkStealingPool.h"
+#include <algorithm>
+
+namespace {
+    // Пул и очередь текущего потока, если он рабочий
+    thread_local const WorkStealingPool* currentPool = nullptr;
+    thread_local unsigned currentWorker = 0;
+}
+
+WorkStealingPool::WorkStealingPool(unsigned threadCount) {
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    for (unsigned i = 0; i < threadCount; ++i) {
+        workers.push_back(std::make_unique<Worker>());
+    }
+    for (unsigned i = 0; i < threadCount; ++i) {
+        threads.emplace_back(&WorkStealingPool::workerLoop, this, i);
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    wait();
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    workAvailable.notify_all();
+    for (std::thread& t : threads) {
+        t.join();
+    }
+}
+
+void WorkStealingPool::submit(Task task) {
+    unsigned target = (currentPool == this) ? currentWorker
+        : nextWorker.fetch_add(1, std::memory_order_relaxed) % size();
+
+    pending++;
+    queued++;
+    {
+        std::lock_guard<std::mutex> lock(workers[target]->mutex);
+        workers[target]->tasks.push_back(std::move(task));
+    }
+
+    // Пустая критическая секция: спящий поток либо уже увидит queued,
+    // либо уже ждет и получит уведомление
+    { std::lock_guard<std::mutex> lock(sleepMutex); }
+    workAvailable.notify_one();
+}
+
+bool WorkStealingPool::tryTake(unsigned self, Task& task) {
+    {
+        Worker& own = *workers[self];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            return true;
+        }
+    }
+    for (unsigned i = 1; i < size(); ++i) {
+        Worker& victim = *workers[(self + i) % size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            stolen.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkStealingPool::workerLoop(unsigned index) {
+    currentPool = this;
+    currentWorker = index;
+
+    while (true) {
+        Task task;
+        if (tryTake(index, task)) {
+            queued--;
+            task();
+            if (--pending == 0) {
+                std::lock_guard<std::mutex> lock(sleepMutex);
+                allDone.notify_all();
+            }
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        workAvailable.wait(lock, [this] { return stopping || queued > 0; });
+        if (stopping && queued == 0) return;
+    }
+}
+
+void WorkStealingPool::wait() {
+    std::unique_lock<std::mutex> lock(sleepMutex);
+    allDone.wait(lock, [this] { return pending == 0; });
+}
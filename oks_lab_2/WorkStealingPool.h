@@ -0,0 +1,57 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//     .     : ,
+//   ,       
+//     (LIFO,    ).    
+//      .     .
+class WorkStealingPool {
+public:
+    using Task = std::function<void()>;
+
+    // 0     
+    explicit WorkStealingPool(unsigned threads = 0);
+    //    
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    void submit(Task task);
+
+    // ,      ,   
+    void wait();
+
+    unsigned size() const { return static_cast<unsigned>(workers.size()); }
+    uint64_t stolenCount() const { return stolen; }
+
+private:
+    struct Worker {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::vector<std::thread> threads;
+
+    std::atomic<size_t> queued{ 0 };   //   
+    std::atomic<size_t> pending{ 0 };  //     
+    std::atomic<unsigned> nextWorker{ 0 };
+    std::atomic<uint64_t> stolen{ 0 };
+    std::atomic<bool> stopping{ false };
+
+    std::mutex sleepMutex;
+    std::condition_variable workAvailable;
+    std::condition_variable allDone;
+
+    bool tryTake(unsigned self, Task& task);
+    void workerLoop(unsigned index);
+};
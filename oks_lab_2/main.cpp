@@ -1,12 +1,455 @@
-﻿#include "ConsoleInterface.h"
-#include <windows.h>
+﻿#include "AsyncLink.h"
+#include "ConsoleInterface.h"
+#include "ConsolePlatform.h"
+#include "CsmaSimulator.h"
+#include "FecHarness.h"
+#include "HammingBlock.h"
+#include "LinkManager.h"
+#include "Log.h"
+#include "Lz.h"
+#include "Trace.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
 
-int main() {
-    system("chcp 1251");
-    system("cls");
+// Заголовок столбца шириной width символов. std::setw считает байты,
+// а у кириллицы в UTF-8 их по два на символ
+static std::string column(const std::string& text, size_t width, bool left = false) {
+    size_t chars = std::count_if(text.begin(), text.end(), [](char c) {
+        return (static_cast<unsigned char>(c) & 0xC0) != 0x80;
+    });
+    std::string pad(width > chars ? width - chars : 0, ' ');
+    return left ? text + pad : pad + text;
+}
+
+// Параметры CSMA для всех режимов: --csma-config FILE и --csma key=value
+// (можно повторять, применяются по порядку). Найденные ключи убираются из args
+static bool extractCsmaParams(std::vector<char*>& args, CSMA::Params& params) {
+    std::vector<char*> rest;
+    for (size_t i = 0; i < args.size(); ++i) {
+        std::string arg = args[i];
+        if (arg != "--csma-config" && arg != "--csma") {
+            rest.push_back(args[i]);
+            continue;
+        }
+        if (i + 1 >= args.size()) { std::cerr << "Нет значения для " << arg << std::endl; return false; }
+        std::string value = args[++i];
+        if (arg == "--csma-config") {
+            std::string error;
+            if (!CSMA::load_params(value, params, error)) { std::cerr << error << std::endl; return false; }
+        }
+        else if (!CSMA::parse_assignment(value, params)) {
+            std::cerr << "Неверный параметр CSMA: " << value << std::endl;
+            return false;
+        }
+    }
+    args.swap(rest);
+    return true;
+}
+
+// Трассировка для всех режимов: --trace FILE включает ее с запуска
+// и при выходе сохраняет JSON для chrome://tracing
+static bool extractTracePath(std::vector<char*>& args, std::string& path) {
+    auto it = std::find_if(args.begin(), args.end(), [](const char* a) { return std::string(a) == "--trace"; });
+    if (it == args.end()) return true;
+    if (it + 1 == args.end()) { std::cerr << "Нет значения для --trace" << std::endl; return false; }
+    path = *(it + 1);
+    args.erase(it, it + 2);
+    return true;
+}
+
+// Подробность журнала: --log-level debug|info|warning|error|off
+static bool extractLogLevel(std::vector<char*>& args) {
+    auto it = std::find_if(args.begin(), args.end(), [](const char* a) { return std::string(a) == "--log-level"; });
+    if (it == args.end()) return true;
+    Log::Level level;
+    if (it + 1 == args.end() || !Log::parse_level(*(it + 1), level)) {
+        std::cerr << "Ожидался уровень журнала: debug, info, warning, error, off" << std::endl;
+        return false;
+    }
+    Log::setLevel(level);
+    args.erase(it, it + 2);
+    return true;
+}
+
+// Моделирование CSMA/CD: --csma-sim [--stations N] [--load G] [--bytes B]
+// [--baud R] [--frames M] [--seed S] [--sweep]
+static int runCsmaSimulation(int argc, char** argv, const CSMA::Params& params) {
+    CsmaSimulator::Config config;
+    config.params = params;
+    bool sweep = false;
+
+    for (int i = 0; i < argc; ++i) {
+        std::string arg = argv[i];
+        const char* value = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        if (arg == "--sweep") { sweep = true; continue; }
+        if (!value) { std::cerr << "Нет значения для " << arg << std::endl; return 1; }
+
+        if (arg == "--stations") config.stations = std::atoi(value);
+        else if (arg == "--load") config.offeredLoad = std::atof(value);
+        else if (arg == "--bytes") config.frameBytes = std::strtoull(value, nullptr, 10);
+        else if (arg == "--baud") config.baudRate = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+        else if (arg == "--frames") config.frames = std::strtoull(value, nullptr, 10);
+        else if (arg == "--seed") config.seed = std::strtoull(value, nullptr, 10);
+        else { std::cerr << "Неизвестный параметр " << arg << std::endl; return 1; }
+        ++i;
+    }
+
+    std::cout << "Станций: " << config.stations << ", кадр " << config.frameBytes << " байт, "
+              << config.baudRate << " бод, кадров: " << config.frames << std::endl;
+    std::cout << "Доступ к каналу: " << CSMA::backoff_name(params.backoff) << ", слот "
+              << params.slotTimeMs << " мс, попыток: " << params.maxAttempts << std::endl;
+    std::cout << column("G", 8) << column("S", 10) << column("Задержка, мс", 14)
+              << column("Коллизии", 12) << column("Отброшено", 11) << column("Кадров/с", 14) << std::endl;
+
+    auto runOne = [](const CsmaSimulator::Config& cfg) {
+        auto start = std::chrono::steady_clock::now();
+        CsmaSimulator::Result r = CsmaSimulator(cfg).run();
+        double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        double rate = wall > 0.0 ? (r.stats.packets_sent + r.dropped) / wall : 0.0;
+
+        std::cout << std::fixed << std::setprecision(2) << std::setw(8) << cfg.offeredLoad
+                  << std::setprecision(4) << std::setw(10) << r.throughput
+                  << std::setprecision(1) << std::setw(14) << r.meanDelayMs
+                  << std::setw(12) << r.stats.collisions
+                  << std::setw(11) << r.dropped
+                  << std::setprecision(0) << std::setw(14) << rate << std::endl;
+    };
+
+    if (!sweep) {
+        runOne(config);
+        return 0;
+    }
+    for (double load : { 0.05, 0.1, 0.2, 0.3, 0.5, 0.7, 1.0, 1.5, 2.0, 3.0, 5.0 }) {
+        config.offeredLoad = load;
+        runOne(config);
+    }
+    return 0;
+}
+
+// Статистика FEC: --fec-sweep [--trials N] [--threads T] [--sizes 1,32,...]
+// [--models lab,bits:2,ber:0.001,burst:4,none] [--fec whole|blocked|interleaved] [--crc] [--fcs] [--seed S]
+static int runFecSweep(int argc, char** argv) {
+    FecHarness::Config config;
+    config.payloadSizes = { 1, 8, 32, 128, 512, 2048, 8192 };
+    config.models = { ChannelNoise::Model::none(), ChannelNoise::Model::lab(), ChannelNoise::Model::fixedBits(2),
+                      ChannelNoise::Model::fixedBits(3), ChannelNoise::Model::bernoulli(1e-3), ChannelNoise::Model::burst(4) };
+
+    for (int i = 0; i < argc; ++i) {
+        std::string arg = argv[i];
+        const char* value = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        if (arg == "--fcs") { config.distortFcs = true; continue; }
+        if (arg == "--crc") { config.crc = true; continue; }
+        if (!value) { std::cerr << "Нет значения для " << arg << std::endl; return 1; }
+
+        if (arg == "--trials") config.trials = std::strtoull(value, nullptr, 10);
+        else if (arg == "--threads") config.threads = static_cast<unsigned>(std::strtoul(value, nullptr, 10));
+        else if (arg == "--seed") config.seed = std::strtoull(value, nullptr, 10);
+        else if (arg == "--fec") {
+            if (!HammingBlock::parse_mode(value, config.mode)) { std::cerr << "Неизвестный режим FEC " << value << std::endl; return 1; }
+        }
+        else if (arg == "--sizes") {
+            config.payloadSizes.clear();
+            std::istringstream list(value);
+            for (std::string item; std::getline(list, item, ',');) {
+                size_t size = std::strtoull(item.c_str(), nullptr, 10);
+                if (size > 0) config.payloadSizes.push_back(size);
+            }
+        }
+        else if (arg == "--models") {
+            config.models.clear();
+            std::istringstream list(value);
+            for (std::string item; std::getline(list, item, ',');) {
+                ChannelNoise::Model model;
+                if (!ChannelNoise::Model::parse(item, model)) { std::cerr << "Неизвестная модель " << item << std::endl; return 1; }
+                config.models.push_back(model);
+            }
+        }
+        else { std::cerr << "Неизвестный параметр " << arg << std::endl; return 1; }
+        ++i;
+    }
+
+    std::cout << "Испытаний на точку: " << config.trials << ", FEC: " << HammingBlock::mode_name(config.mode)
+              << (config.crc ? " + CRC-32C" : "") << (config.distortFcs ? ", искажается и FCS" : "") << std::endl;
+    std::cout << column("Модель", 12) << column("Байт", 8) << column("Исправлено", 12)
+              << column("Обнаружено", 12) << column("Пропущено", 12) << column("МБ/с", 10) << std::endl;
+
+    auto percent = [&](uint64_t n) { return 100.0 * n / std::max<uint64_t>(config.trials, 1); };
+    for (const ChannelNoise::Model& model : config.models) {
+        for (size_t size : config.payloadSizes) {
+            FecHarness::Result r = FecHarness::runPoint(config, size, model);
+            std::cout << std::setw(12) << model.name() << std::setw(8) << size
+                      << std::fixed << std::setprecision(4)
+                      << std::setw(11) << percent(r.corrected) << "%"
+                      << std::setw(11) << percent(r.detected) << "%"
+                      << std::setw(11) << percent(r.miscorrected) << "%"
+                      << std::setprecision(1) << std::setw(10) << r.megabytesPerSecond << std::endl;
+        }
+    }
+    return 0;
+}
+
+#ifdef __linux__
+// Одна линия: отправляет сообщения и собирает их кадры на своем же порту приема
+static AsyncTask runLinkSession(AsyncLink& link, int messages, size_t bytes, int& mismatches, int& active) {
+    const auto RECEIVE_WAIT = std::chrono::milliseconds(500);
+
+    std::string message(bytes, '\0');
+    for (size_t i = 0; i < bytes; ++i) message[i] = static_cast<char>('a' + i % 26);
+
+    for (int m = 0; m < messages; ++m) {
+        if (!co_await link.sendMessage(message)) {
+            mismatches++;
+            continue;
+        }
+        std::string received;
+        std::vector<uint8_t> packed;
+        while (received.size() < message.size()) {
+            // Без ARQ кадр может пропасть: ждем не дольше RECEIVE_WAIT
+            std::optional<Frame> frame = co_await link.receiveFrame(Timing::Clock::now() + RECEIVE_WAIT);
+            if (!frame) break;
+            frame->correct_in_place();
+            if (!frame->isCompressed()) {
+                received.append(reinterpret_cast<const char*>(frame->data.data()), frame->data.size());
+                continue;
+            }
+            // Блок распаковывается, когда придет целиком
+            packed.insert(packed.end(), frame->data.begin(), frame->data.end());
+            if (Lz::decompress(packed, received) != 0) packed.clear();
+        }
+        if (received != message) mismatches++;
+    }
+    active--;
+}
+
+// Много линий в одном потоке: --async-links [--links N] [--messages M]
+// [--bytes B] [--baud R] [--noise none|lab|bits:K|...] [--fec whole|blocked|interleaved] [--crc] [--compress] [--compact].
+// Порты LOOP<n>A/LOOP<n>B
+static int runAsyncLinks(int argc, char** argv, const CSMA::Params& params) {
+    int links = 32;
+    int messages = 10;
+    size_t bytes = 256;
+    uint32_t baud = 115200;
+    ChannelNoise::Model noise = ChannelNoise::Model::none();
+    FecMode fec = FecMode::Whole;
+    bool crc = false;
+    bool compress = false;
+    bool compact = false;
+
+    for (int i = 0; i < argc; ++i) {
+        std::string arg = argv[i];
+        const char* value = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        if (arg == "--crc") { crc = true; continue; }
+        if (arg == "--compress") { compress = true; continue; }
+        if (arg == "--compact") { compact = true; continue; }
+        if (!value) { std::cerr << "Нет значения для " << arg << std::endl; return 1; }
+
+        if (arg == "--links") links = std::atoi(value);
+        else if (arg == "--messages") messages = std::atoi(value);
+        else if (arg == "--bytes") bytes = std::strtoull(value, nullptr, 10);
+        else if (arg == "--baud") baud = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+        else if (arg == "--noise") {
+            if (!ChannelNoise::Model::parse(value, noise)) { std::cerr << "Неизвестная модель " << value << std::endl; return 1; }
+        }
+        else if (arg == "--fec") {
+            if (!HammingBlock::parse_mode(value, fec)) { std::cerr << "Неизвестный режим FEC " << value << std::endl; return 1; }
+        }
+        else { std::cerr << "Неизвестный параметр " << arg << std::endl; return 1; }
+        ++i;
+    }
+
+    Reactor reactor;
+    if (!reactor.valid()) { std::cerr << "Не удалось создать epoll" << std::endl; return 1; }
+
+    std::vector<std::unique_ptr<AsyncLink>> pool;
+    for (int i = 0; i < links; ++i) {
+        auto link = std::make_unique<AsyncLink>(reactor, params);
+        std::string base = "LOOP" + std::to_string(1000 + i);
+        if (!link->open(base + "A", base + "B", baud)) { std::cerr << "Не удалось открыть " << base << std::endl; return 1; }
+        link->setNoise(noise);
+        link->setFecMode(fec);
+        link->setCrc(crc);
+        link->setCompression(compress);
+        link->setCompactHeader(compact);
+        pool.push_back(std::move(link));
+    }
+
+    std::cout << "Линий: " << links << ", сообщений на линию: " << messages << " по " << bytes << " байт, "
+              << baud << " бод, доступ: " << CSMA::backoff_name(params.backoff) << std::endl;
+
+    auto start = std::chrono::steady_clock::now();
+    int mismatches = 0;
+    int active = links;
+    for (auto& link : pool) {
+        runLinkSession(*link, messages, bytes, mismatches, active);
+    }
+    while (active > 0) {
+        reactor.runOnce(Timing::NO_DEADLINE);
+    }
+    double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    CSMA::Stats total;
+    CSMA::HistogramSnapshot latency;
+    for (auto& link : pool) {
+        CSMA::StatsSnapshot snap = link->getSnapshot();
+        const CSMA::Stats& s = snap.totals;
+        latency += snap.frameLatencyUs;
+        total.packets_sent += s.packets_sent;
+        total.collisions += s.collisions;
+        total.busy_events += s.busy_events;
+        total.frames_received += s.frames_received;
+        total.uncorrectable_frames += s.uncorrectable_frames;
+    }
+    std::cout << std::fixed << std::setprecision(2)
+              << "Кадров передано: " << total.packets_sent << ", принято: " << total.frames_received
+              << ", неисправимых: " << total.uncorrectable_frames << std::endl
+              << "Коллизий: " << total.collisions << ", канал занят: " << total.busy_events << std::endl
+              << "Отправка кадра, мс: p50 " << latency.percentile(0.5) / 1000.0
+              << ", p99 " << latency.percentile(0.99) / 1000.0 << std::endl
+              << "Сообщений с ошибками: " << mismatches << " из " << links * messages << std::endl
+              << "Время: " << wall << " с, кадров/с: " << std::setprecision(0) << total.packets_sent / wall << std::endl;
+    return 0;
+}
+
+// Много пар портов на нескольких реакторах и пуле потоков: --multi-link
+// [--count N | --pairs A:B,C:D] [--messages M] [--bytes B] [--baud R]
+// [--reactors K] [--workers W] [--payload P] [--noise ...] [--fec ...] [--crc] [--compact]. По умолчанию порты LOOP<n>A/LOOP<n>B
+static int runMultiLink(int argc, char** argv, const CSMA::Params& params) {
+    LinkManager::Config config;
+    config.params = params;
+    config.noise = ChannelNoise::Model::none();
+    int count = 16;
+    int messages = 10;
+    size_t bytes = 4096;
+    std::vector<std::pair<std::string, std::string>> pairs;
+
+    for (int i = 0; i < argc; ++i) {
+        std::string arg = argv[i];
+        const char* value = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        if (arg == "--crc") { config.crc = true; continue; }
+        if (arg == "--compact") { config.compactHeader = true; continue; }
+        if (!value) { std::cerr << "Нет значения для " << arg << std::endl; return 1; }
 
-    ConsoleInterface app;
+        if (arg == "--count") count = std::atoi(value);
+        else if (arg == "--messages") messages = std::atoi(value);
+        else if (arg == "--bytes") bytes = std::strtoull(value, nullptr, 10);
+        else if (arg == "--baud") config.baudRate = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+        else if (arg == "--reactors") config.reactors = static_cast<unsigned>(std::strtoul(value, nullptr, 10));
+        else if (arg == "--workers") config.workers = static_cast<unsigned>(std::strtoul(value, nullptr, 10));
+        else if (arg == "--payload") config.payloadSize = std::strtoull(value, nullptr, 10);
+        else if (arg == "--noise") {
+            if (!ChannelNoise::Model::parse(value, config.noise)) { std::cerr << "Неизвестная модель " << value << std::endl; return 1; }
+        }
+        else if (arg == "--fec") {
+            if (!HammingBlock::parse_mode(value, config.fec)) { std::cerr << "Неизвестный режим FEC " << value << std::endl; return 1; }
+        }
+        else if (arg == "--pairs") {
+            std::istringstream list(value);
+            std::string item;
+            while (std::getline(list, item, ',')) {
+                size_t colon = item.find(':');
+                if (colon == std::string::npos) { std::cerr << "Ожидалось ОТПР:ПРИЕМ: " << item << std::endl; return 1; }
+                pairs.emplace_back(item.substr(0, colon), item.substr(colon + 1));
+            }
+        }
+        else { std::cerr << "Неизвестный параметр " << arg << std::endl; return 1; }
+        ++i;
+    }
+    if (pairs.empty()) {
+        for (int i = 0; i < count; ++i) {
+            std::string base = "LOOP" + std::to_string(2000 + i);
+            pairs.emplace_back(base + "A", base + "B");
+        }
+    }
+
+    LinkManager manager(config);
+    for (const auto& [send, receive] : pairs) {
+        if (manager.addLink(send, receive) < 0) { std::cerr << "Не удалось открыть " << send << "/" << receive << std::endl; return 1; }
+    }
+
+    std::string message(bytes, '\0');
+    for (size_t i = 0; i < bytes; ++i) message[i] = static_cast<char>('a' + i % 26);
+
+    manager.start();
+    for (int m = 0; m < messages; ++m) {
+        for (size_t l = 0; l < manager.linkCount(); ++l) {
+            manager.send(static_cast<int>(l), message);
+        }
+    }
+    manager.waitIdle();
+    manager.stop();
+
+    std::cout << "Линий: " << manager.linkCount() << ", реакторов: " << manager.reactorCount()
+              << ", рабочих потоков: " << manager.workerCount() << ", перехвачено задач: " << manager.stolenTasks() << std::endl;
+    std::cout << column("Линия", 24, true) << column("Сообщ.", 10)
+              << column("Кадров", 10) << column("Исправл.", 10) << column("Коллизий", 10)
+              << column("КБ/с", 12) << std::endl;
+
+    auto printRow = [](const LinkManager::LinkStats& s) {
+        std::cout << std::left << std::setw(24) << (s.sendPort + " -> " + s.receivePort) << std::right
+                  << std::setw(10) << s.messagesSent << std::setw(10) << s.framesReceived
+                  << std::setw(10) << s.framesCorrected << std::setw(10) << s.collisions
+                  << std::fixed << std::setprecision(1) << std::setw(12) << s.throughput() / 1024.0 << std::endl;
+    };
+    for (const auto& s : manager.linkStats()) {
+        printRow(s);
+    }
+    LinkManager::LinkStats total = manager.totalStats();
+    printRow(total);
+    std::cout << "Неудачных сообщений: " << total.messagesFailed << ", неисправимых кадров: " << total.framesUncorrectable
+              << std::setprecision(2) << ", время: " << total.seconds << " с" << std::endl;
+    return 0;
+}
+#endif
+
+static int runMode(std::vector<char*>& args, const CSMA::Params& csmaParams) {
+    if (!args.empty() && std::string(args[0]) == "--csma-sim") {
+        return runCsmaSimulation(static_cast<int>(args.size()) - 1, args.data() + 1, csmaParams);
+    }
+    if (!args.empty() && std::string(args[0]) == "--fec-sweep") {
+        return runFecSweep(static_cast<int>(args.size()) - 1, args.data() + 1);
+    }
+#ifdef __linux__
+    if (!args.empty() && std::string(args[0]) == "--async-links") {
+        return runAsyncLinks(static_cast<int>(args.size()) - 1, args.data() + 1, csmaParams);
+    }
+    if (!args.empty() && std::string(args[0]) == "--multi-link") {
+        return runMultiLink(static_cast<int>(args.size()) - 1, args.data() + 1, csmaParams);
+    }
+#endif
+
+    ConsolePlatform::init();
+
+    ConsoleInterface app(csmaParams);
     app.run();
 
     return 0;
 }
+
+int main(int argc, char** argv) {
+    std::vector<char*> args(argv + 1, argv + argc);
+    CSMA::Params csmaParams;
+    std::string tracePath;
+    if (!extractCsmaParams(args, csmaParams) || !extractTracePath(args, tracePath) || !extractLogLevel(args)) {
+        return 1;
+    }
+
+    if (!tracePath.empty()) Trace::setEnabled(true);
+    int result = runMode(args, csmaParams);
+    Log::flush();
+
+    if (!tracePath.empty()) {
+        Trace::setEnabled(false);
+        if (!Trace::exportChrome(tracePath)) {
+            std::cerr << "Не удалось записать трассу в " << tracePath << std::endl;
+            return 1;
+        }
+        std::cout << "Трасса: " << Trace::recordCount() << " записей в " << tracePath << std::endl;
+    }
+    return result;
+}
\ No newline at end of file